@@ -9,6 +9,8 @@
 #ifndef DWARFPP_ABSTRACT_HPP_
 #define DWARFPP_ABSTRACT_HPP_
 
+#include <boost/utility/string_ref.hpp>
+
 #include "util.hpp"
 #include "spec.hpp"
 #include "opt.hpp"
@@ -38,6 +40,12 @@ namespace dwarf
 		using dwarf::spec::opt;
 		using dwarf::spec::spec;
 		using dwarf::spec::DEFAULT_DWARF_SPEC; // FIXME: ... or get rid of spec:: namespace?
+		
+		/* A name that we haven't copied. For libdwarf-backed DIEs it points
+		 * into the mapped .debug_str or .debug_info, so it lives as long as
+		 * the Dwarf_Debug; for in-memory DIEs, as long as the DIE's name
+		 * attribute. An empty name_ref means "no name". */
+		typedef boost::string_ref name_ref;
 
 		/* This is a small interface designed to be implementable over both 
 		 * libdwarf Dwarf_Die handles and whatever other representation we 
@@ -55,6 +63,8 @@ namespace dwarf
 			// - it fixes string deletion behaviour to libdwarf-style, 
 			// - it creates a circular dependency with the contents of libdwarf-handles.hpp
 			//virtual unique_ptr<const char, string_deleter> get_raw_name() const = 0;
+			// ... but we can do this, since nobody has to delete anything
+			virtual name_ref get_name_ref() const = 0;
 			virtual Dwarf_Off get_enclosing_cu_offset() const = 0;
 			virtual bool has_attr(Dwarf_Half attr) const = 0;
 			inline bool has_attribute(Dwarf_Half attr) const { return has_attr(attr); }
@@ -120,6 +130,11 @@ namespace dwarf
 			Dwarf_Half get_tag() const { return m_tag; }
 			opt<string> get_name() const 
 			{ return has_attr(DW_AT_name) ? m_attrs.find(DW_AT_name)->second.get_string() : opt<string>(); }
+			name_ref get_name_ref() const
+			{
+				auto found = m_attrs.find(DW_AT_name);
+				return (found != m_attrs.end()) ? name_ref(found->second.get_string()) : name_ref();
+			}
 			Dwarf_Off get_enclosing_cu_offset() const 
 			{ return m_cu_offset; }
 			bool has_attr(Dwarf_Half attr) const 
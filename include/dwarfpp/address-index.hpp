@@ -0,0 +1,160 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * address-index.hpp: from addresses to the DIEs that cover them.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_ADDRESS_INDEX_HPP_
+#define DWARFPP_ADDRESS_INDEX_HPP_
+
+#include <vector>
+#include <utility>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::pair;
+
+		/* Asking each subprogram whether it spans_addr() rebuilds its
+		 * intervals every time, and finding the innermost block or inlined
+		 * call means doing it again for each level. The address_index is built
+		 * once, in one walk, over every DIE with code ranges: CUs, subprograms,
+		 * lexical blocks, inlined calls and so on. Addresses are the
+		 * file-relative ones found in DWARF, as for spans_addr().
+		 *
+		 * Ranged DIEs nest, so we cut the address space into disjoint
+		 * segments, each labelled with the innermost DIE covering it. Looking
+		 * up an address is a binary search over the segments. Each DIE's node
+		 * records the nearest ranged DIE enclosing it, so the rest of the
+		 * chain is a walk up the parent links.
+		 *
+		 * The index is immutable and doesn't know about later changes to
+		 * in-memory DIEs. */
+		class address_index
+		{
+		public:
+			typedef unsigned node_id;
+			static constexpr node_id NO_NODE = ~0u;
+			struct node
+			{
+				Dwarf_Off off;
+				Dwarf_Half tag;
+				node_id parent; // nearest enclosing ranged DIE, or NO_NODE
+			};
+		private:
+			vector<node> nodes;
+			/* The segments, sorted and disjoint, kept column-wise so that the
+			 * binary search only touches the start addresses. */
+			vector<Dwarf_Addr> seg_begins;
+			vector<Dwarf_Addr> seg_ends;
+			vector<node_id> seg_nodes;
+
+			struct interval
+			{
+				Dwarf_Addr lo;
+				Dwarf_Addr hi;
+				node_id n;
+				unsigned short depth;
+			};
+			void add_segment(Dwarf_Addr lo, Dwarf_Addr hi, node_id n);
+			void build_segments(vector<interval>& intervals);
+		public:
+			explicit address_index(root_die& r);
+			/* Which tags do we index? Those which can have code ranges. */
+			static bool tag_has_code_ranges(Dwarf_Half tag);
+			/* The non-empty code ranges of one DIE, from its attributes. */
+			static void intervals_here(root_die& r, const iterator_base& i,
+				vector<pair<Dwarf_Addr, Dwarf_Addr> >& out);
+
+			/* The innermost ranged DIE covering addr. */
+			node_id innermost(Dwarf_Addr addr) const;
+			/* ... also saying up to where the answer stays the same, for
+			 * callers walking addresses in order. */
+			node_id innermost(Dwarf_Addr addr, Dwarf_Addr *out_until) const;
+			/* The whole chain covering addr, innermost first, CU last. */
+			vector<node_id> chain(Dwarf_Addr addr) const;
+			/* The nearest covering DIE with the given tag, e.g. the
+			 * subprogram, however deeply inlined calls nest within it. */
+			node_id enclosing(Dwarf_Addr addr, Dwarf_Half tag) const;
+
+			const node& get(node_id n) const { return nodes.at(n); }
+			unsigned size() const { return nodes.size(); }
+			unsigned segment_count() const { return seg_begins.size(); }
+		};
+
+		/* Often all we want is the CU, e.g. to pick a line table. For that
+		 * we don't need a walk over every DIE. .debug_aranges, if present,
+		 * lists each CU's code ranges; otherwise we use each CU's own
+		 * attributes. Producers don't always emit aranges for every CU,
+		 * or for all of a CU, so we check each CU's attribute ranges
+		 * against its aranges and add any that aren't covered. We keep
+		 * the result sorted by start address, with a running maximum end,
+		 * as below. */
+		class cu_range_index
+		{
+		public:
+			struct range
+			{
+				Dwarf_Addr lo;
+				Dwarf_Addr hi;
+				Dwarf_Off cu;
+			};
+		private:
+			vector<range> ranges;
+			vector<Dwarf_Addr> max_hi;
+			unsigned ncus_patched; // CUs the aranges missed, wholly or partly
+			static void read_aranges(root_die& r, vector<range>& out);
+		public:
+			explicit cu_range_index(root_die& r);
+
+			/* The offset of the CU covering addr, if any. */
+			opt<Dwarf_Off> cu_for(Dwarf_Addr addr) const;
+			const vector<range>& all() const { return ranges; }
+			unsigned size() const { return ranges.size(); }
+			unsigned cus_patched() const { return ncus_patched; }
+		};
+
+		/* The same for data: which static variable, and which part of it,
+		 * is at a given file-relative address. Variables don't nest, so
+		 * we just keep their extents sorted by start address. They can
+		 * overlap, e.g. an alias and its target, so we also keep the
+		 * running maximum end address, to know how far back to look. */
+		class static_data_index
+		{
+		public:
+			struct entry
+			{
+				Dwarf_Addr lo;
+				Dwarf_Addr hi;
+				Dwarf_Off var;
+			};
+		private:
+			vector<entry> entries;
+			vector<Dwarf_Addr> max_hi; // max_hi[k] is the greatest hi in entries[0..k]
+		public:
+			explicit static_data_index(root_die& r);
+
+			/* The variable covering addr with the greatest start, or null. */
+			const entry *find(Dwarf_Addr addr) const;
+			vector<const entry *> find_all(Dwarf_Addr addr) const;
+			const vector<entry>& all() const { return entries; }
+			unsigned size() const { return entries.size(); }
+
+			/* Within an aggregate, the chain of data members, outermost
+			 * first, reaching the byte at addr. Array elements are stepped
+			 * through, not listed. The offset left over within the last
+			 * thing reached (member or element) goes in *out_residual. */
+			static vector<iterator_base> members_at(root_die& r, const entry& e,
+				Dwarf_Addr addr, Dwarf_Unsigned *out_residual = nullptr);
+		};
+	}
+}
+
+#endif
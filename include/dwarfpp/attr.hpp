@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "spec.hpp"
+#include "small-map.hpp"
 #include "libdwarf.hpp" /* includes libdwarf.h, Error, No_entry, some fwddecls */
 
 #include <boost/optional.hpp>
@@ -40,6 +41,7 @@ namespace dwarf
 		using namespace dwarf::lib;
 		class rangelist;
 		class loclist;
+		struct pooled_loclist;
 		using core::root_die;
 		using core::debug;
 		
@@ -114,6 +116,10 @@ namespace dwarf
 		private:
 			Dwarf_Half orig_form;
 			form f; // discriminant
+			/* If f == LOCLIST, whether we hold v_pooled_loclist, a reference
+			 * on an entry in a root's loclist_pool, rather than owning
+			 * v_loclist. */
+			bool loclist_is_pooled = false;
 			union {
 				Dwarf_Bool v_flag;
 				Dwarf_Unsigned v_u;
@@ -124,9 +130,11 @@ namespace dwarf
 				std::string *v_string;
 				weak_ref *v_ref;
 				encap::loclist *v_loclist;
+				const pooled_loclist *v_pooled_loclist;
 				encap::rangelist *v_rangelist;
 			};
 			static form dwarf_form_to_form(const Dwarf_Half form); // helper hack
+			void set_pooled_loclist(root_die& r, const loclist& l);
 			// -- the operator<< is a friend (WHY?)
 			friend std::ostream& ::dwarf::lib::operator<<(std::ostream& s, const dwarf::lib::Dwarf_Loc& l);
 
@@ -171,7 +179,7 @@ namespace dwarf
 			bool is_address() const { return f == ADDR /* || f == UNSIGNED*/; }
 			address get_address() const { assert(is_address()); return/* (f == ADDR) ?*/ v_addr /*: address(static_cast<Dwarf_Addr>(v_u))*/; }
 			bool is_loclist() const { return f == LOCLIST; }
-			const loclist& get_loclist() const { assert(is_loclist()); return *v_loclist; }
+			const loclist& get_loclist() const; // may unpack a pooled loclist
 			bool is_rangelist() const { return f == RANGELIST; }
 			const rangelist& get_rangelist() const { assert(is_rangelist()); return *v_rangelist; }
 			bool is_ref() const { return f == REF; }
@@ -194,13 +202,37 @@ namespace dwarf
 			//friend std::ostream& operator<<(std::ostream& o, const dwarf::encap::die& d);
 			// copy constructor
 			attribute_value(const attribute_value& av);
+			/* move constructor: we take over any heap-allocated value,
+			 * leaving av as a NO_ATTR that owns nothing. This is what lets
+			 * attribute_map shuffle its elements around cheaply. */
+			attribute_value(attribute_value&& av) noexcept
+			 : orig_form(av.orig_form), f(av.f), loclist_is_pooled(av.loclist_is_pooled),
+			   v_u(av.v_u) // v_u spans the whole union
+			{ av.f = NO_ATTR; }
+			/* Declaring the move constructor would delete these, so spell
+			 * them out, by copy (or move) and swap. */
+			attribute_value& operator=(const attribute_value& av)
+			{ attribute_value tmp(av); swap(tmp); return *this; }
+			attribute_value& operator=(attribute_value&& av) noexcept
+			{ attribute_value tmp(std::move(av)); swap(tmp); return *this; }
+			void swap(attribute_value& av) noexcept
+			{
+				std::swap(orig_form, av.orig_form);
+				std::swap(f, av.f);
+				std::swap(loclist_is_pooled, av.loclist_is_pooled);
+				std::swap(v_u, av.v_u); // v_u spans the whole union
+			}
 			
 			virtual ~attribute_value();
 		}; // end class attribute_value
 		
-		struct attribute_map : public std::map<Dwarf_Half, attribute_value> 
+		/* Most DIEs have fewer than eight attributes, so we keep them in a
+		 * flat sorted array rather than a std::map, and only go to the heap
+		 * for the unusual DIE that has more. Note that this means inserting
+		 * invalidates iterators. */
+		struct attribute_map : public small_sorted_map<Dwarf_Half, attribute_value, 8>
 		{
-			typedef std::map<Dwarf_Half, attribute_value> base;
+			typedef small_sorted_map<Dwarf_Half, attribute_value, 8> base;
 			// forward constructors
 			//forward_constructors(base, attribute_map)
 			// hmm -- this messes with overload resolution; just forward default for now
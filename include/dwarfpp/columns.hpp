@@ -0,0 +1,148 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * columns.hpp: bulk, columnar projection of attributes over many DIEs.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_COLUMNS_HPP_
+#define DWARFPP_COLUMNS_HPP_
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+
+		/* Indexing clients tend to want the same handful of attributes
+		 * (name, type, byte_size, ...) from a very large number of DIEs,
+		 * and don't want an attribute_map, or even an attribute_value, for each.
+		 * An attr_columns holds one row per DIE and one column per requested
+		 * attribute, with every value flattened to a Dwarf_Unsigned. What the
+		 * value means is recorded per cell, because it depends on the form. */
+		struct attr_columns
+		{
+			enum value_kind
+			{
+				ABSENT = 0,
+				ATOM,           // a string; value indexes into strings
+				UNSIGNED,
+				SIGNED,         // stored two's-complement in the Dwarf_Unsigned
+				ADDRESS,        // including a location that is just DW_OP_addr
+				FLAG,
+				REFERENCE,      // global .debug_info offset of the referenced DIE
+				SECTION_OFFSET, // lineptr, loclistptr, rangelistptr, macptr
+				OPAQUE,         // present, but not flattenable; use attr() on the DIE
+				FAILED          // present, but libdwarf couldn't decode it
+			};
+			struct column
+			{
+				Dwarf_Half attr;
+				vector<unsigned char> kinds; // one value_kind per row
+				vector<Dwarf_Unsigned> values;
+
+				value_kind kind(unsigned row) const { return static_cast<value_kind>(kinds[row]); }
+				bool has(unsigned row) const { return kinds[row] != ABSENT; }
+				Dwarf_Unsigned get_unsigned(unsigned row) const { return values[row]; }
+				Dwarf_Signed get_signed(unsigned row) const
+				{ return static_cast<Dwarf_Signed>(values[row]); }
+			};
+
+			vector<Dwarf_Off> offsets;
+			vector<Dwarf_Half> tags;
+			vector<column> columns;
+
+			/* Strings are interned per projection, so that a name column
+			 * can be compared and grouped as integers. */
+			vector<string> strings;
+			std::unordered_map<string, unsigned> string_atoms;
+
+			attr_columns(const vector<Dwarf_Half>& attrs)
+			{
+				for (auto i_attr = attrs.begin(); i_attr != attrs.end(); ++i_attr)
+				{
+					column c;
+					c.attr = *i_attr;
+					columns.push_back(std::move(c));
+				}
+			}
+
+			unsigned size() const { return offsets.size(); }
+			/* Column lookup by attribute; returns nullptr if not projected. */
+			const column *col(Dwarf_Half attr) const
+			{
+				for (auto i_col = columns.begin(); i_col != columns.end(); ++i_col)
+				{
+					if (i_col->attr == attr) return &*i_col;
+				}
+				return nullptr;
+			}
+			const string& string_at(const column& c, unsigned row) const
+			{ assert(c.kind(row) == ATOM); return strings.at(c.values[row]); }
+			unsigned intern(const char *s);
+		};
+
+		/* The projector does the work. The main saving is that for each
+		 * distinct abbreviation it sees, it records which positions in the
+		 * DIE's attribute list hold the attributes we want, with what form
+		 * and what interpretation. All DIEs sharing that abbreviation are
+		 * then decoded without consulting the spec, and those having none
+		 * of our attributes are not decoded at all. */
+		class attr_projector
+		{
+			root_die& r;
+			attr_columns& out;
+			struct slot
+			{
+				int index; // position in the DIE's attribute list, or -1 if absent
+				Dwarf_Half form;
+				int cls;
+				bool indirect; // DW_FORM_indirect: form must be read per-DIE
+				bool failed; // couldn't read the form, so every such cell is FAILED
+			};
+			struct layout
+			{
+				vector<slot> slots; // one per column
+				bool any;
+			};
+			/* Abbreviation codes are only unique within a CU's abbreviation
+			 * table, so we key on the CU offset too. */
+			std::map<pair<Dwarf_Off, Dwarf_Unsigned>, layout> layouts;
+
+			layout make_layout(Dwarf_Attribute *attrs, Dwarf_Signed len, spec& s) const;
+			void decode(Dwarf_Attribute a, const slot& sl, Dwarf_Die d, spec& s,
+				attr_columns::column& c, unsigned row);
+			void add_generic(const iterator_base& i, unsigned row);
+		public:
+			attr_projector(root_die& r, attr_columns& out) : r(r), out(out) {}
+			void add(const iterator_base& i);
+			unsigned layouts_seen() const { return layouts.size(); }
+		};
+
+		/* Project over any sequence of DIE iterators... */
+		template <typename Iter>
+		inline attr_columns
+		project_attrs(root_die& r, Iter pos, Iter end, const vector<Dwarf_Half>& attrs)
+		{
+			attr_columns out(attrs);
+			attr_projector p(r, out);
+			for (; pos != end; ++pos) p.add(pos);
+			return out;
+		}
+		/* ... or over every DIE with a given tag. */
+		attr_columns
+		project_attrs(root_die& r, Dwarf_Half tag, const vector<Dwarf_Half>& attrs);
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * demangled-names.hpp: subprograms and variables by demangled name.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_DEMANGLED_NAMES_HPP_
+#define DWARFPP_DEMANGLED_NAMES_HPP_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+
+		/* C++ users think in signatures like ns::Foo::bar(int) const, but
+		 * DIEs have a mangled linkage name and an unqualified DW_AT_name.
+		 * The demangled_name_index demangles each subprogram's and variable's
+		 * linkage name and files the DIE under the result, in normalized
+		 * form, and also under just its qualified name, i.e. without the
+		 * parameters. External C functions and variables, having no linkage
+		 * name, are filed under their plain name.
+		 *
+		 * Normalizing removes whitespace except between two identifier
+		 * characters, so "std::vector<int, std::allocator<int> >" and
+		 * "std::vector<int,std::allocator<int>>" are the same key, but
+		 * "unsigned int" keeps its space. Queries are normalized likewise.
+		 *
+		 * Each distinct mangled string is demangled once; the results are
+		 * kept and available through demangle(). */
+		class demangled_name_index
+		{
+			std::unordered_map<string, string> demangled; // mangled -> demangled, or "" if not mangled
+			std::unordered_multimap<string, Dwarf_Off> by_signature;
+			std::unordered_multimap<string, Dwarf_Off> by_qualified_name;
+
+			static vector<Dwarf_Off> collect(
+				const std::unordered_multimap<string, Dwarf_Off>& m, const string& key);
+		public:
+			explicit demangled_name_index(root_die& r);
+
+			static string normalize(const string& s);
+			/* Drop the parameters, any qualifiers after them, and any
+			 * return type before the name (as templates have). */
+			static string strip_signature(const string& normalized);
+
+			/* Every DIE whose demangled name is this signature. */
+			vector<Dwarf_Off> find_signature(const string& signature) const;
+			/* ... or whose qualified name is this, whatever its parameters,
+			 * e.g. all overloads of ns::Foo::bar. */
+			vector<Dwarf_Off> find_qualified(const string& qualified) const;
+
+			/* The demangled form of a linkage name, from our cache if we have
+			 * seen it, or none if it isn't a mangled name. */
+			opt<string> demangle(const string& mangled) const;
+			unsigned distinct_mangled_names() const { return demangled.size(); }
+			unsigned size() const { return by_signature.size(); }
+		};
+	}
+}
+
+#endif
@@ -21,25 +21,22 @@ namespace dwarf
 	
 	namespace core
 	{
-		/* FIXME: these use libdwarf-specific StringList -- how to abstract this?
-		 * Add to abstract_die? Move to root_die? As a private interface on root_die
-		 * with which compile_unit_die is friendly? */
+		/* These index the file table that load_source_files() caches on the
+		 * payload; only it touches libdwarf (and its StringList). */
 		inline std::string compile_unit_die::source_file_name(unsigned o) const
 		{
-			StringList names(d);
-			//if (!names) throw Error(current_dwarf_error, 0);
+			if (!source_files) load_source_files();
 			/* Source file numbers in DWARF are indexed starting from 1. 
 			 * Source file zero means "no source file".
-			 * However, our array filesbuf is indexed beginning zero! */
-			assert(o <= names.get_len()); // FIXME: how to report error? ("throw No_entry();"?)
-			return names[o - 1];
+			 * However, our vector is indexed beginning zero! */
+			assert(o <= source_files->size()); // FIXME: how to report error? ("throw No_entry();"?)
+			return source_files->at(o - 1);
 		}
 
 		inline unsigned compile_unit_die::source_file_count() const
 		{
-			// FIXME: cache some stuff
-			StringList names(d);
-			return names.get_len();
+			if (!source_files) load_source_files();
+			return source_files->size();
 		}
 	}
 }
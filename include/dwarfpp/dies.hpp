@@ -89,9 +89,15 @@ namespace dwarf
  * virtual inheritance to wire its getters up to those versions. 
  * ARGH: no, we need another round of these macros to enumerate all the getters. 
  */
+/* The getter first tries to decode straight from the form (see the
+ * direct_attr_ functions below), and only if that declines does it go
+ * through has_attr() and a full attribute_value. */
 #define attr_optional(name, stored_t) \
 	opt<stored_type_ ## stored_t> get_ ## name() const \
-	{ if (has_attr(DW_AT_ ## name)) \
+	{ bool fallback = false; \
+	  opt<stored_type_ ## stored_t> direct = direct_attr_ ## stored_t(d, DW_AT_ ## name, fallback); \
+	  if (!fallback) return direct; \
+	  if (has_attr(DW_AT_ ## name)) \
 	  {  /* we have to check the form matches our expectations */ \
 		 encap::attribute_value a = attr(DW_AT_ ## name); \
 		 if (!a.is_ ## stored_t ()) { \
@@ -125,6 +131,26 @@ namespace dwarf
 #define child_tag(arg)
 
 	struct type_die; 
+	
+	/* Fast paths for the generated get_ accessors. Each decodes the
+	 * attribute from its form, for the forms that the stored type is
+	 * normally written in, returning an empty opt if the attribute is
+	 * absent. If the DIE isn't libdwarf-backed, or the form is something
+	 * else, it sets `fallback' and the accessor does it the generic way. */
+	opt<stored_type_string> direct_attr_string(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_flag> direct_attr_flag(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_unsigned> direct_attr_unsigned(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_signed> direct_attr_signed(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_address> direct_attr_address(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_refiter> direct_attr_refiter(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_refiter_is_type> direct_attr_refiter_is_type(const Die& d, Dwarf_Half attr, bool& fallback);
+	opt<stored_type_loclist> direct_attr_loclist(const Die& d, Dwarf_Half attr, bool& fallback);
+	// not worth it for these
+	inline opt<stored_type_offset> direct_attr_offset(const Die& d, Dwarf_Half attr, bool& fallback)
+	{ fallback = true; return opt<stored_type_offset>(); }
+	inline opt<stored_type_rangelist> direct_attr_rangelist(const Die& d, Dwarf_Half attr, bool& fallback)
+	{ fallback = true; return opt<stored_type_rangelist>(); }
+	
 	struct with_static_location_die : public virtual basic_die
 	{
 		struct sym_binding_t 
@@ -905,6 +931,18 @@ public: \
 inline std::string source_file_name(unsigned o) const; \
 opt<std::string> source_file_fq_pathname(unsigned o) const; \
 inline unsigned source_file_count() const; \
+protected: \
+/* The file table, and each file's full path, read once (CUs are sticky). */ \
+mutable opt<std::vector<std::string> > source_files; \
+mutable std::vector<opt<std::string> > source_files_fq; \
+void load_source_files() const; \
+public: \
+/* The decoded line number program, built on first use (line-table.hpp). */ \
+const line_table& get_line_table() const; \
+protected: \
+mutable std::shared_ptr<line_table> p_line_table; \
+friend class root_die; /* for load_line_tables() */ \
+public: \
 /* We define fields and getters for the per-CU info (NOT attributes) */ \
 /* available from libdwarf. These will be filled in by root_die::make_payload(). */ \
 protected: \
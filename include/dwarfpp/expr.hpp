@@ -11,6 +11,8 @@
 
 #include <vector>
 #include <stack>
+#include <unordered_map>
+#include <memory>
 #include <boost/icl/interval_map.hpp>
 #include <strings.h> // for bzero
 #include "spec.hpp"
@@ -264,6 +266,42 @@ namespace dwarf
 		};
 		std::ostream& operator<<(std::ostream& s, const loclist& ll);
 		
+		/* Most location lists in a big binary are one of a few short
+		 * expressions, like DW_OP_fbreg N or DW_OP_plus_uconst N, repeated
+		 * many times. A root_die keeps one of these pools, and attribute_values
+		 * that it creates point into it rather than owning a copy. Pooled
+		 * loclists are immutable and reference-counted: intern() and acquire()
+		 * each take a reference, release() drops one, and the last release
+		 * removes the loclist from the pool. Entries may outlive the pool
+		 * itself, e.g. an attribute_value copied out of a root_die that has
+		 * since gone away; the pool's table lives until its last entry does.
+		 * Within one pool, two live loclists are equal iff they are the same
+		 * object. An entry stores its loclist as a packed_loclist, and only
+		 * unpacks it (keeping the result) when someone asks for it with get(),
+		 * so locations that are copied around but never read stay small. */
+		struct pooled_loclist; // see expr.cpp
+		class loclist_pool
+		{
+			friend struct pooled_loclist;
+			struct table
+			{
+				std::unordered_multimap<size_t, pooled_loclist *> by_hash;
+			};
+			std::shared_ptr<table> p_table;
+		public:
+			loclist_pool() : p_table(std::make_shared<table>()) {}
+			loclist_pool(const loclist_pool&) = delete;
+			loclist_pool& operator=(const loclist_pool&) = delete;
+			/* Returns the pooled copy of l, holding one reference to it. */
+			const pooled_loclist *intern(const loclist& l);
+			static void acquire(const pooled_loclist *pooled);
+			static void release(const pooled_loclist *pooled);
+			static const loclist& get(const pooled_loclist *pooled);
+			size_t size() const { return p_table->by_hash.size(); }
+			/* Bytes of packed storage held by the pool's entries. */
+			size_t bytes_used() const;
+		};
+		
 		/* Instruction sequences in a CIE/FDE. */
 		struct frame_instrlist;
 		/* We need this extension so that we can define operator<<, since to construct a 
@@ -0,0 +1,70 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * inline-frames.hpp: the stack of inlined calls at an address.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_INLINE_FRAMES_HPP_
+#define DWARFPP_INLINE_FRAMES_HPP_
+
+#include <vector>
+
+#include "root.hpp"
+#include "address-index.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+
+		/* Symbolizing optimized code means turning a pc into the calls
+		 * inlined there: each inlined_subroutine covering it, where it was
+		 * called from, and what it is an instance of. The address_index
+		 * already finds the covering DIEs by binary search and a walk up
+		 * parent links. The inline_frame_index adds, for each of its
+		 * inlined_subroutine and subprogram nodes, the call site and the
+		 * resolved origin, i.e. the end of the DW_AT_abstract_origin chain,
+		 * so a query is O(log n) plus O(depth) with no DIE access.
+		 *
+		 * Call files are indexes into the CU's file table, as in DWARF;
+		 * compile_unit_die::source_file_name() turns them into names. */
+		class inline_frame_index
+		{
+		public:
+			struct frame
+			{
+				Dwarf_Off die;      // the inlined_subroutine, or the subprogram
+				Dwarf_Half tag;
+				Dwarf_Off origin;   // what it is an instance of; die itself if nothing
+				Dwarf_Off cu;
+				/* Where it was called from, in the next frame out; zero
+				 * if not known, and for the subprogram. */
+				Dwarf_Unsigned call_file;
+				Dwarf_Unsigned call_line;
+				Dwarf_Unsigned call_column;
+			};
+		private:
+			const address_index& idx;
+			/* Parallel to the address_index's nodes. Only the frames'
+			 * entries are filled in. */
+			vector<frame> frames;
+			static Dwarf_Off resolve_origin(root_die& r, const iterator_base& i);
+		public:
+			explicit inline_frame_index(root_die& r);
+
+			/* Innermost first, ending with the concrete subprogram. Empty if
+			 * no subprogram covers addr. */
+			vector<frame> stack(Dwarf_Addr addr) const
+			{ return stack_from(idx.innermost(addr)); }
+			/* The same, starting from a node of the address_index. */
+			vector<frame> stack_from(address_index::node_id innermost) const;
+			/* Just the depth of inlining at addr. */
+			unsigned inline_depth(Dwarf_Addr addr) const;
+		};
+	}
+}
+
+#endif
@@ -282,6 +282,13 @@ namespace dwarf
 			name_here() const;
 			opt<string> 
 			global_name_here() const;
+			/* Like name_here(), but without copying; see name_ref. */
+			name_ref
+			name_ref_here() const;
+			/* Whether DW_AT_declaration is set here, not looking through
+			 * specification or abstract_origin links. */
+			bool
+			is_declaration_here() const;
 			
 			inline spec& spec_here() const;
 			
@@ -299,6 +306,7 @@ namespace dwarf
 			{ return dynamic_cast<Die&>(get_handle()).name_here(); } 
 			inline opt<string> get_name() const 
 			{ return /*opt<string>(string(get_raw_name().get())); */ get_handle().get_name(); }
+			inline name_ref get_name_ref() const { return name_ref_here(); }
 		public:
 			inline Dwarf_Off get_enclosing_cu_offset() const 
 			{ return enclosing_cu_offset_here(); }
@@ -792,6 +800,12 @@ namespace dwarf
 		inline unsigned short iterator_base::depth() const
 		{
 			if (m_opt_depth) return *m_opt_depth;
+			/* For libdwarf-backed DIEs, the CU's offset index knows. */
+			if (state == HANDLE_ONLY || cur_payload->d.handle)
+			{
+				auto located = get_root().locate_in_cu(offset_here(), enclosing_cu_offset_here());
+				if (located) { this->m_opt_depth = located->first; return *m_opt_depth; }
+			}
 			/* find_upwards is not enough; 
 			 * the parent cache (parent_of) might not be complete. */
 			auto found_self = get_root().find(offset_here(),
@@ -828,9 +842,8 @@ namespace dwarf
 				if (ret)
 				{
 					/* install in cache */
-					string name = *i_g.name_here();
-					r.visible_named_grandchildren_cache.insert(
-						make_pair(name, i_g.offset_here())
+					r.cache_visible_named_grandchild(
+						r.intern_name(i_g.name_ref_here()), i_g.offset_here()
 					);
 				}
 				/* Have we now swept the entire sequence of grandchildren? 
@@ -50,4 +50,17 @@
 #include "iter-inl.hpp"
 #include "dies-inl.hpp"
 
+#include "columns.hpp"
+#include "packed-expr.hpp"
+#include "qualified-names.hpp"
+#include "address-index.hpp"
+#include "inline-frames.hpp"
+#include "line-table.hpp"
+#include "symbolize.hpp"
+#include "reverse-refs.hpp"
+#include "type-names.hpp"
+#include "symbols.hpp"
+#include "name-dictionary.hpp"
+#include "demangled-names.hpp"
+
 #endif
@@ -61,6 +61,17 @@ namespace dwarf
 			raw_handle_type raw_handle()       { return handle.get(); }
 			raw_handle_type raw_handle() const { return handle.get(); }
 		};
+		/* A Debug of its own for a worker thread, opened afresh on a file
+		 * that some root_die already has open, since libdwarf handles can't
+		 * be shared between threads. Unlike Debug(int fd), we close the Elf. */
+		struct WorkerDebug
+		{
+			::Elf *elf;
+			Debug dbg;
+			WorkerDebug(int fd);
+			~WorkerDebug();
+			Debug::raw_handle_type raw_handle() { return dbg.raw_handle(); }
+		};
 
 		// Also there are some other kinds of libdwarf resource.
 		struct string_deleter
@@ -142,6 +153,7 @@ namespace dwarf
 			Dwarf_Off offset_here() const;
 			Dwarf_Half tag_here() const;
 			std::unique_ptr<const char, string_deleter> name_here() const;
+			name_ref name_ref_here() const;
 			Dwarf_Off enclosing_cu_offset_here() const;
 			bool has_attr_here(Dwarf_Half attr) const;
 			bool has_attribute_here(Dwarf_Half attr) const { return has_attr_here(attr); }
@@ -160,6 +172,7 @@ namespace dwarf
 			{ return name_here() ? opt<string>(string(name_here().get())) : opt<string>(); }
 			inline unique_ptr<const char, string_deleter> get_raw_name() const
 			{ return name_here(); }
+			inline name_ref get_name_ref() const { return name_ref_here(); }
 			inline Dwarf_Off get_enclosing_cu_offset() const 
 			{ return enclosing_cu_offset_here(); }
 			inline bool has_attr(Dwarf_Half attr) const { return has_attr_here(attr); }
@@ -491,9 +504,8 @@ namespace dwarf
 
 		/* Do the list handles. */
 		list_handle(Locdesc, const Attribute& a)
-		list_handle(Line, const iterator_base& it)
-		list_handle(Arange)
-		list_handle(Global)
+		list_handle(Arange, Debug::raw_handle_type dbg)
+		list_handle(Global, Debug::raw_handle_type dbg)
 		
 		/* RangesList is special because it uses its own deallocation function. Also,
 		 * don't bother to copy the list. */
@@ -534,6 +546,40 @@ namespace dwarf
 			{ if (!handle) throw Error(current_dwarf_error, 0); }
 		};
 
+		/* LineList is likewise special: libdwarf wants the whole block back
+		 * through dwarf_srclines_dealloc(), not line by line. Index the
+		 * handle directly rather than copying the list. */
+		struct LineList
+		{
+			typedef Dwarf_Line *raw_handle_type; /* What libdwarf returns us. */
+			typedef Dwarf_Line raw_element_type;
+			/* This is a whole-list deleter. */
+			struct deleter
+			{
+				Debug::raw_handle_type dbg;
+				Dwarf_Signed len;
+				deleter(Debug::raw_handle_type dbg, Dwarf_Signed len) : dbg(dbg), len(len) {}
+				void operator()(raw_handle_type arg) const
+				{
+					if (arg) dwarf_srclines_dealloc(dbg, arg, len);
+				}
+			};
+			Debug::raw_handle_type get_dbg() const { return handle.get_deleter().dbg; }
+			typedef unique_ptr<raw_element_type, deleter> handle_type;
+			handle_type handle;
+
+			static inline handle_type
+			try_construct(const Die& d);
+			/* ... or from a raw DIE, e.g. on a worker's own Debug. */
+			static inline handle_type
+			try_construct(Debug::raw_handle_type dbg, Dwarf_Die d);
+
+			/* We tolerate a null handle -- it just means the empty list. */
+			LineList(handle_type h) : handle(std::move(h)) {}
+			Dwarf_Signed size() const { return handle ? handle.get_deleter().len : 0; }
+			Dwarf_Line operator[](Dwarf_Signed i) const { return handle.get()[i]; }
+		};
+
 		/* srcfiles, which is a list of strings */
 		struct StringList
 		{
@@ -691,6 +737,43 @@ namespace dwarf
 			copy_list();
 		}
 		
+		inline GlobalList::handle_type
+		GlobalList::try_construct(Debug::raw_handle_type dbg)
+		{
+			Dwarf_Global *block_start;
+			Dwarf_Signed count;
+			int ret = dwarf_get_globals(dbg, &block_start, &count, &current_dwarf_error);
+			/* No .debug_pubnames is common, and we just return an empty list.
+			 * Our list deleter can't cope with the (void*)-1 hack, so use null. */
+			if (ret == DW_DLV_OK && count > 0) return handle_type(block_start, deleter(dbg, count));
+			else return handle_type(nullptr, deleter(dbg, 0));
+		}
+		inline LineList::handle_type
+		LineList::try_construct(Debug::raw_handle_type dbg, Dwarf_Die d)
+		{
+			Dwarf_Line *block_start;
+			Dwarf_Signed count;
+			int ret = dwarf_srclines(d, &block_start, &count, &current_dwarf_error);
+			/* A CU with no line number program is fine; it has no lines. */
+			if (ret == DW_DLV_OK && count > 0) return handle_type(block_start, deleter(dbg, count));
+			else return handle_type(nullptr, deleter(dbg, 0));
+		}
+		inline LineList::handle_type
+		LineList::try_construct(const Die& d)
+		{
+			return try_construct(d.get_dbg(), d.raw_handle());
+		}
+		inline ArangeList::handle_type
+		ArangeList::try_construct(Debug::raw_handle_type dbg)
+		{
+			Dwarf_Arange *block_start;
+			Dwarf_Signed count;
+			int ret = dwarf_get_aranges(dbg, &block_start, &count, &current_dwarf_error);
+			/* Likewise, no .debug_aranges gives an empty list. */
+			if (ret == DW_DLV_OK && count > 0) return handle_type(block_start, deleter(dbg, count));
+			else return handle_type(nullptr, deleter(dbg, 0));
+		}
+		
 		inline Locdesc::handle_type
 		Locdesc::try_construct(const Attribute& a)
 		{
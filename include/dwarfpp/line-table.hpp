@@ -0,0 +1,116 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * line-table.hpp: a CU's decoded line number program, compactly.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_LINE_TABLE_HPP_
+#define DWARFPP_LINE_TABLE_HPP_
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <boost/functional/hash.hpp>
+
+#include "root.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::pair;
+
+		/* libdwarf gives us one allocated Dwarf_Line per row, and a call
+		 * per field. A line_table decodes them once and keeps the rows in
+		 * a byte buffer, each row as deltas from the one before:
+		 *    ULEB128 of (address delta << 4 | flags), flags being
+		 *            is_stmt, end_sequence, file changed, column changed;
+		 *    SLEB128 line delta;
+		 *    ULEB128 file, if changed;
+		 *    ULEB128 column, if changed.
+		 * Every CHECKPOINT_INTERVAL rows, and at the start of every sequence,
+		 * we keep a checkpoint row in full, so a lookup is a binary search
+		 * over sequences, then over their checkpoints, then decoding at most
+		 * that many rows.
+		 *
+		 * Sequences are sorted by start address, but can overlap, e.g. when
+		 * the linker discards functions and leaves their sequences at zero.
+		 * So, as for static_data_index, we keep a running maximum end.
+		 *
+		 * Files are numbers in the CU's file table, as in DWARF; see
+		 * compile_unit_die::source_file_name(). */
+		class line_table
+		{
+		public:
+			struct row
+			{
+				Dwarf_Addr addr;
+				Dwarf_Unsigned file;
+				Dwarf_Unsigned line;
+				Dwarf_Unsigned column;
+				bool is_stmt;
+				bool end_sequence;
+			};
+			static const unsigned CHECKPOINT_INTERVAL = 32;
+		private:
+			vector<unsigned char> bytes;
+			/* checkpoints[k] starts at byte offsets[k] and runs up to the next
+			 * checkpoint's; its first row is held in full, not in bytes. */
+			vector<row> checkpoints;
+			vector<unsigned> offsets;
+			struct sequence
+			{
+				Dwarf_Addr lo;
+				Dwarf_Addr hi; // the end_sequence row's address
+				unsigned first_checkpoint;
+				unsigned end_checkpoint;
+			};
+			vector<sequence> sequences;
+			vector<Dwarf_Addr> max_hi;
+			unsigned nrows;
+
+			/* The reverse index is only built if someone asks. */
+			typedef pair<Dwarf_Unsigned, Dwarf_Unsigned> file_and_line;
+			mutable std::unordered_map<file_and_line, vector<Dwarf_Addr>,
+				boost::hash<file_and_line> > by_file_and_line;
+			mutable bool reverse_index_built;
+			void build_reverse_index() const;
+
+			static vector<row> decode(const Die& cu);
+			static vector<row> decode(Dwarf_Debug dbg, Dwarf_Die cu);
+			static vector<row> decode_at(Dwarf_Debug dbg, Dwarf_Off cu_off);
+			void add_sequence(const vector<row>& rows);
+			/* Call f on each row from checkpoint k up to the next,
+			 * stopping early if f returns false. */
+			template <typename F> void decode_block(unsigned k, F f) const;
+		public:
+			/* Build from a libdwarf-backed CU; any other has no lines. */
+			explicit line_table(const Die& cu);
+			/* ... given by offset, through any libdwarf handle on the file,
+			 * so that worker threads can use their own; see
+			 * root_die::load_line_tables(). */
+			line_table(Dwarf_Debug dbg, Dwarf_Off cu_off);
+			explicit line_table(vector<row> decoded);
+
+			/* The row in effect at addr, if any: the last row at or before it,
+			 * unless that ends a sequence. */
+			opt<row> find(Dwarf_Addr addr) const { return find(addr, nullptr); }
+			/* ... also saying up to where the same row stays in effect. */
+			opt<row> find(Dwarf_Addr addr, Dwarf_Addr *out_until) const;
+			/* The start addresses of the statements on a line. */
+			vector<Dwarf_Addr> addresses_for(Dwarf_Unsigned file, Dwarf_Unsigned line) const;
+			/* Everything, sorted by sequence, for dumping. */
+			vector<row> all_rows() const;
+
+			unsigned size() const { return nrows; }
+			unsigned sequence_count() const { return sequences.size(); }
+			size_t bytes_used() const { return bytes.size() + checkpoints.size() * sizeof (row)
+				+ offsets.size() * sizeof (unsigned) + sequences.size() * sizeof (sequence); }
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,78 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * name-dictionary.hpp: every DIE name, sorted, for pattern searches.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_NAME_DICTIONARY_HPP_
+#define DWARFPP_NAME_DICTIONARY_HPP_
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <boost/regex.hpp>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+		using std::pair;
+
+		/* "All functions named serialize-something" used to mean walking
+		 * every DIE and asking for its name. The name_dictionary does that
+		 * walk once. It keeps each distinct DW_AT_name (as a root name atom)
+		 * in sorted order, and for each, the DIEs with that name, in file
+		 * order, with their tags. A prefix is a binary search. A glob or
+		 * regex is a scan over the distinct names, not the DIEs; a glob's
+		 * literal prefix narrows the scan first.
+		 *
+		 * Names are the DIEs' own, not qualified; for qualified names, see
+		 * qualified_name_index. Queries take an optional tag, 0 meaning any.
+		 * The root drops its copy when in-memory DIEs are added or named. */
+		class name_dictionary
+		{
+		public:
+			struct entry
+			{
+				Dwarf_Off off;
+				Dwarf_Half tag;
+			};
+		private:
+			root_die& r;
+			vector<root_die::name_atom> names; // sorted by the name's text
+			vector<unsigned> first_entry; // one more than names
+			vector<entry> entries;
+
+			/* Names [lo, hi) whose text is between these bounds. */
+			pair<unsigned, unsigned> prefix_range(name_ref prefix) const;
+			void append_entries(unsigned n, Dwarf_Half tag, vector<Dwarf_Off>& out) const;
+		public:
+			explicit name_dictionary(root_die& r);
+
+			vector<Dwarf_Off> exact(const string& name, Dwarf_Half tag = 0) const;
+			vector<Dwarf_Off> with_prefix(const string& prefix, Dwarf_Half tag = 0) const;
+			/* Shell-style: *, ? and [...], as for fnmatch(). */
+			vector<Dwarf_Off> matching_glob(const string& pattern, Dwarf_Half tag = 0) const;
+			/* The whole name must match, as for boost::regex_match. */
+			vector<Dwarf_Off> matching_regex(const boost::regex& re, Dwarf_Half tag = 0) const;
+
+			/* The distinct names, in order, for callers who want to do
+			 * their own matching. */
+			unsigned distinct_names() const { return names.size(); }
+			name_ref name_at(unsigned n) const { return r.name_for_atom(names.at(n)); }
+			pair<const entry *, const entry *> entries_at(unsigned n) const
+			{ return std::make_pair(entries.data() + first_entry.at(n),
+				entries.data() + first_entry.at(n + 1)); }
+			unsigned size() const { return entries.size(); }
+		};
+	}
+}
+
+#endif
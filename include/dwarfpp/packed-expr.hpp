@@ -0,0 +1,191 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * packed-expr.hpp: location lists flattened into a single byte buffer.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_PACKED_EXPR_HPP_
+#define DWARFPP_PACKED_EXPR_HPP_
+
+#include <vector>
+#include <cstring>
+#include <iterator>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/functional/hash.hpp>
+
+#include "expr.hpp"
+
+namespace dwarf
+{
+	namespace encap
+	{
+		using std::vector;
+
+		/* A loclist is a vector of loc_exprs, each with its own vector of
+		 * wide expr_instrs. That's fine for building and rewriting, but for
+		 * storing many of them and scanning them by vaddr, we want one
+		 * allocation per list and something closer to DWARF's own density.
+		 * A packed_loclist is built from a loclist and is immutable. It is
+		 * how a root_die's loclist_pool stores the locations it shares.
+		 *
+		 * The buffer holds each entry in turn:
+		 *    lopc, hipc        8 bytes each, host byte order
+		 *    body length       ULEB128, so we can skip entries without decoding
+		 *    body              per instruction:
+		 *                         opcode byte;
+		 *                         byte saying which of lr_number, lr_number2 follow;
+		 *                         lr_offset, as a ULEB128 delta from the previous;
+		 *                         the operands, as SLEB128.
+		 * Operands are stored signed because the common large ones are
+		 * negative frame offsets; an address costs the same either way. */
+		class packed_loclist
+		{
+			vector<unsigned char> bytes;
+			unsigned nentries;
+		public:
+			/* The packing is private to us, so our LEB128 routines don't
+			 * have to cope with anything but what we wrote. */
+			static Dwarf_Unsigned read_uleb(const unsigned char *& pos)
+			{
+				Dwarf_Unsigned working = 0;
+				unsigned shift = 0;
+				unsigned char b;
+				do
+				{
+					b = *pos++;
+					working |= static_cast<Dwarf_Unsigned>(b & 0x7f) << shift;
+					shift += 7;
+				} while (b & 0x80);
+				return working;
+			}
+			static Dwarf_Signed read_sleb(const unsigned char *& pos)
+			{
+				Dwarf_Unsigned working = 0;
+				unsigned shift = 0;
+				unsigned char b;
+				do
+				{
+					b = *pos++;
+					working |= static_cast<Dwarf_Unsigned>(b & 0x7f) << shift;
+					shift += 7;
+				} while (b & 0x80);
+				if (shift < 64 && (b & 0x40)) working |= ~static_cast<Dwarf_Unsigned>(0) << shift;
+				return static_cast<Dwarf_Signed>(working);
+			}
+
+			/* Decoding the instructions of one entry. */
+			class instr_iterator : public boost::iterator_facade<
+				instr_iterator, const expr_instr, std::forward_iterator_tag
+			>
+			{
+				friend class boost::iterator_core_access;
+				const unsigned char *pos;  // the *next* instruction
+				const unsigned char *limit;
+				expr_instr cur;
+				bool at_end;
+
+				void decode()
+				{
+					if (pos == limit) { at_end = true; return; }
+					Dwarf_Unsigned prev_offset = cur.lr_offset;
+					cur.lr_atom = *pos++;
+					unsigned char which = *pos++;
+					cur.lr_offset = prev_offset + read_uleb(pos);
+					cur.lr_number = (which & 1) ? static_cast<Dwarf_Unsigned>(read_sleb(pos)) : 0;
+					cur.lr_number2 = (which & 2) ? static_cast<Dwarf_Unsigned>(read_sleb(pos)) : 0;
+				}
+				void increment() { decode(); }
+				bool equal(const instr_iterator& i) const
+				{ return at_end == i.at_end && (at_end || pos == i.pos); }
+				const expr_instr& dereference() const { return cur; }
+			public:
+				instr_iterator(const unsigned char *pos, const unsigned char *limit)
+				 : pos(pos), limit(limit), at_end(false)
+				{ std::memset(&cur, 0, sizeof cur); decode(); }
+				instr_iterator() : pos(nullptr), limit(nullptr), at_end(true) {}
+			};
+
+			/* One entry, i.e. what in a loclist is a loc_expr. */
+			struct entry
+			{
+				Dwarf_Addr lopc;
+				Dwarf_Addr hipc;
+				const unsigned char *body_begin;
+				const unsigned char *body_end;
+
+				instr_iterator begin() const { return instr_iterator(body_begin, body_end); }
+				instr_iterator end() const { return instr_iterator(); }
+				bool covers(Dwarf_Addr vaddr) const
+				{ return (lopc == 0 && hipc == 0) || (vaddr >= lopc && vaddr < hipc); }
+				loc_expr unpack(const spec::abstract_def& spec = spec::dwarf_current) const
+				{
+					loc_expr e(begin(), end(), spec);
+					e.lopc = lopc;
+					e.hipc = hipc;
+					return e;
+				}
+			};
+
+			/* Walking the entries only reads their headers. */
+			class entry_iterator : public boost::iterator_facade<
+				entry_iterator, const entry, std::forward_iterator_tag
+			>
+			{
+				friend class boost::iterator_core_access;
+				const unsigned char *pos; // the *next* entry
+				const unsigned char *limit;
+				entry cur;
+				bool at_end;
+
+				void decode()
+				{
+					if (pos == limit) { at_end = true; return; }
+					std::memcpy(&cur.lopc, pos, sizeof cur.lopc); pos += sizeof cur.lopc;
+					std::memcpy(&cur.hipc, pos, sizeof cur.hipc); pos += sizeof cur.hipc;
+					Dwarf_Unsigned len = read_uleb(pos);
+					cur.body_begin = pos;
+					cur.body_end = pos + len;
+					pos = cur.body_end;
+				}
+				void increment() { decode(); }
+				bool equal(const entry_iterator& i) const
+				{ return at_end == i.at_end && (at_end || pos == i.pos); }
+				const entry& dereference() const { return cur; }
+			public:
+				entry_iterator(const unsigned char *pos, const unsigned char *limit)
+				 : pos(pos), limit(limit), at_end(false) { decode(); }
+				entry_iterator() : pos(nullptr), limit(nullptr), at_end(true) {}
+			};
+			typedef entry_iterator const_iterator;
+			typedef entry_iterator iterator;
+
+			packed_loclist() : nentries(0) {}
+			explicit packed_loclist(const loclist& l);
+
+			entry_iterator begin() const
+			{ return entry_iterator(bytes.data(), bytes.data() + bytes.size()); }
+			entry_iterator end() const { return entry_iterator(); }
+			unsigned size() const { return nentries; }
+			bool empty() const { return nentries == 0; }
+			size_t bytes_used() const { return bytes.size(); }
+
+			/* Like loclist::loc_for_vaddr, but without unpacking the entries
+			 * we skip, and honouring the "lopc == hipc == 0 means all vaddrs"
+			 * convention (see loc_expr). Returns end() if nothing covers vaddr. */
+			entry_iterator entry_for_vaddr(Dwarf_Addr vaddr) const
+			{
+				for (auto i = begin(); i != end(); ++i) if (i->covers(vaddr)) return i;
+				return end();
+			}
+			loclist unpack(const spec::abstract_def& spec = spec::dwarf_current) const;
+
+			size_t hash() const { return boost::hash_range(bytes.begin(), bytes.end()); }
+			bool operator==(const packed_loclist& l) const { return bytes == l.bytes; }
+			bool operator!=(const packed_loclist& l) const { return !(*this == l); }
+		};
+	}
+}
+
+#endif
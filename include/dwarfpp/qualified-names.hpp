@@ -0,0 +1,153 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * qualified-names.hpp: a whole-file trie of qualified names.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_QUALIFIED_NAMES_HPP_
+#define DWARFPP_QUALIFIED_NAMES_HPP_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/functional/hash.hpp>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+
+		/* Resolving a path like std::__cxx11::basic_string<char>::npos
+		 * means a named-child lookup per component, starting from every
+		 * visible grandchild with the first name. The qualified_name_index
+		 * walks the file once and records every named path from the root,
+		 * i.e. named DIEs nested within named DIEs whose tags have named
+		 * children, starting from the CUs' visible children. Anonymous
+		 * scopes aren't descended into, since no path names them.
+		 *
+		 * That is more than resolve() follows: it takes only the first
+		 * child of a given name in each scope, whereas the trie records all
+		 * of them. So alongside the trie we keep, for each scope we
+		 * descended into, the first child of each name. Once the root has
+		 * built the index, resolve_all() and friends answer from that, a
+		 * hash probe per component, and resolve_all_visible_from_root()
+		 * takes its candidates from the trie's top level.
+		 *
+		 * The trie's nodes are path prefixes. Its edges live in one hash
+		 * table keyed by (parent node, name atom), using the root's atoms.
+		 * Several DIEs can share a node, e.g. a namespace reopened in many
+		 * CUs, or a declaration and a definition.
+		 *
+		 * It's a snapshot. The root drops the copy it keeps (see
+		 * get_qualified_name_index()) when in-memory DIEs are added or named. */
+		class qualified_name_index
+		{
+		public:
+			typedef unsigned node_id;
+			static constexpr node_id ROOT_NODE = 0;
+		private:
+			root_die& r;
+			struct node
+			{
+				root_die::name_atom component;
+				node_id parent;
+				vector<node_id> children;
+				vector<Dwarf_Off> dies;
+			};
+			vector<node> nodes;
+			typedef std::pair<node_id, root_die::name_atom> edge;
+			std::unordered_map<edge, node_id, boost::hash<edge> > edges;
+			/* The first child of each name in each DIE we descended into,
+			 * i.e. what named_child() finds there, and which DIEs those are. */
+			typedef std::pair<Dwarf_Off, root_die::name_atom> scoped_name;
+			std::unordered_map<scoped_name, Dwarf_Off, boost::hash<scoped_name> > first_named;
+			std::unordered_set<Dwarf_Off> scopes;
+
+			node_id child_node(node_id parent, root_die::name_atom component);
+			void add_children(const iterator_base& scope, node_id n, spec& s);
+			static const vector<Dwarf_Off> no_dies;
+		public:
+			explicit qualified_name_index(root_die& r);
+
+			/* Find the node for a path, given as a sequence of components. */
+			template <typename Iter>
+			opt<node_id> find_node(Iter path_pos, Iter path_end) const
+			{
+				node_id cur = ROOT_NODE;
+				for (; path_pos != path_end; ++path_pos)
+				{
+					/* A name nobody has interned names no edge. */
+					root_die::name_atom a = r.find_name_atom(name_ref(*path_pos));
+					if (a == root_die::NO_NAME_ATOM) return opt<node_id>();
+					auto found = edges.find(edge(cur, a));
+					if (found == edges.end()) return opt<node_id>();
+					cur = found->second;
+				}
+				return cur;
+			}
+			opt<node_id> find_node(const string& qualified, const string& sep = "::") const
+			{
+				vector<string> path = split(qualified, sep);
+				return find_node(path.begin(), path.end());
+			}
+			/* Split a qualified name at separators, ignoring any inside
+			 * template arguments, as in basic_string<char, std::char_traits<char> >. */
+			static vector<string> split(const string& qualified, const string& sep = "::");
+
+			/* The DIEs at a path; empty if there are none. */
+			template <typename Iter>
+			const vector<Dwarf_Off>& find(Iter path_pos, Iter path_end) const
+			{
+				opt<node_id> n = find_node(path_pos, path_end);
+				return n ? nodes[*n].dies : no_dies;
+			}
+			const vector<Dwarf_Off>& find(const string& qualified, const string& sep = "::") const
+			{
+				opt<node_id> n = find_node(qualified, sep);
+				return n ? nodes[*n].dies : no_dies;
+			}
+			/* Whether we know all of a DIE's named children. If so,
+			 * first_child_named() gives what named_child() would find,
+			 * nothing meaning there is no child of that name. */
+			bool knows_children_of(Dwarf_Off scope) const
+			{ return scopes.find(scope) != scopes.end(); }
+			opt<Dwarf_Off> first_child_named(Dwarf_Off scope, name_ref name) const
+			{
+				root_die::name_atom a = r.find_name_atom(name);
+				if (a == root_die::NO_NAME_ATOM) return opt<Dwarf_Off>();
+				auto found = first_named.find(scoped_name(scope, a));
+				if (found == first_named.end()) return opt<Dwarf_Off>();
+				return found->second;
+			}
+			/* The visible grandchildren with a given name, in CU order. */
+			const vector<Dwarf_Off>& visible_grandchildren_named(name_ref name) const
+			{
+				root_die::name_atom a = r.find_name_atom(name);
+				if (a == root_die::NO_NAME_ATOM) return no_dies;
+				auto found = edges.find(edge(ROOT_NODE, a));
+				return found == edges.end() ? no_dies : nodes[found->second].dies;
+			}
+
+			/* Everything strictly under a node, e.g. all of a namespace's
+			 * contents, in every CU, at every depth. */
+			vector<Dwarf_Off> all_under(node_id n) const;
+
+			const vector<Dwarf_Off>& dies_at(node_id n) const { return nodes.at(n).dies; }
+			const vector<node_id>& children_of(node_id n) const { return nodes.at(n).children; }
+			node_id parent_of(node_id n) const { return nodes.at(n).parent; }
+			name_ref component_of(node_id n) const { return r.name_for_atom(nodes.at(n).component); }
+			vector<string> path_of(node_id n) const;
+			unsigned size() const { return nodes.size(); }
+		};
+	}
+}
+
+#endif
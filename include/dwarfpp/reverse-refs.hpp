@@ -0,0 +1,65 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * reverse-refs.hpp: which DIEs refer to a given DIE.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_REVERSE_REFS_HPP_
+#define DWARFPP_REVERSE_REFS_HPP_
+
+#include <vector>
+#include <utility>
+
+#include "root.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::pair;
+
+		/* The root keeps references forwards, from (source, attr) to target.
+		 * Type-usage and dead-type analyses want them backwards. This index
+		 * inverts every reference in the file, except DW_AT_sibling, which
+		 * is structure rather than meaning. It's in CSR form: the distinct
+		 * targets, sorted, then for each target a contiguous run of edges,
+		 * sorted by (source, attr). The forward references are indexed a CU
+		 * at a time first (see root_die::index_all_references).
+		 *
+		 * Like the root's other indexes, it's a snapshot, and it knows
+		 * nothing of DIEs created after it was built. */
+		class reverse_reference_index
+		{
+		public:
+			struct edge
+			{
+				Dwarf_Off source;
+				Dwarf_Half attr;
+			};
+			typedef const edge *edge_iterator;
+		private:
+			vector<Dwarf_Off> targets;
+			vector<unsigned> first_edge; // one more than targets; edges of targets[k] are [first_edge[k], first_edge[k+1])
+			vector<edge> edges;
+		public:
+			explicit reverse_reference_index(root_die& r);
+
+			/* Everything referring to target, by any attribute. */
+			pair<edge_iterator, edge_iterator> referrers(Dwarf_Off target) const;
+			/* Only those referring by the given attribute, e.g. DW_AT_type. */
+			vector<Dwarf_Off> referrers(Dwarf_Off target, Dwarf_Half attr) const;
+			unsigned count_referrers(Dwarf_Off target) const
+			{ auto rs = referrers(target); return rs.second - rs.first; }
+			bool is_referenced(Dwarf_Off target) const
+			{ auto rs = referrers(target); return rs.first != rs.second; }
+
+			const vector<Dwarf_Off>& all_targets() const { return targets; }
+			unsigned size() const { return edges.size(); }
+		};
+	}
+}
+
+#endif
@@ -16,6 +16,7 @@
 #include "root.hpp"
 #include "iter.hpp"
 #include "dies.hpp"
+#include "qualified-names.hpp"
 
 namespace dwarf
 {
@@ -34,6 +35,28 @@ namespace dwarf
 			if (path_pos == path_end) 
 			{ results.push_back(start); /* out of names, so unconditional */ return; }
 
+			/* If we've built the trie, it knows what named_child() would
+			 * find in the scopes it descended into. Follow it as far as it
+			 * goes, without materialising the DIEs in between. */
+			if (p_qualified_names && start.is_real_die_position()
+				&& p_qualified_names->knows_children_of(start.offset_here()))
+			{
+				Dwarf_Off cur = start.offset_here();
+				Dwarf_Off parent = cur;
+				opt<unsigned short> depth = start.maybe_depth();
+				for (; path_pos != path_end && p_qualified_names->knows_children_of(cur); ++path_pos)
+				{
+					opt<Dwarf_Off> found = p_qualified_names->first_child_named(cur, name_ref(*path_pos));
+					if (!found) return; // the trie has all the named children here
+					parent = cur;
+					cur = *found;
+					if (depth) depth = *depth + 1;
+				}
+				/* From a scope we didn't descend into, carry on the slow way. */
+				resolve_all(pos(cur, depth, parent), path_pos, path_end, results, max);
+				return;
+			}
+
 			Iter cur_plus_one = path_pos; cur_plus_one++;
 			if (cur_plus_one == path_end)
 			{
@@ -79,33 +102,72 @@ namespace dwarf
 				resolve_all(i, cur_plus_one, path_end, results, max);
 			};
 			
-			auto matching_cached = visible_named_grandchildren_cache.equal_range(*path_pos);
-			for (auto i_cached = matching_cached.first;
-				i_cached != matching_cached.second; 
-				++i_cached)
+			/* If the name has no atom, nobody has seen it, so it's not cached.
+			 * Returns true if we have all the results we want. */
+			name_ref wanted(*path_pos);
+			auto resolve_cached = [this, &hit_in_cache, &results, max, &recurse, wanted]() -> bool {
+				auto found = visible_named_grandchildren_cache.find(find_name_atom(wanted));
+				if (found == visible_named_grandchildren_cache.end()) return false;
+				const std::vector<Dwarf_Off>& offs = found->second;
+				for (unsigned n = 0; n < offs.size(); ++n)
+				{
+					if (!hit_in_cache.insert(offs[n]).second) continue;
+					recurse(pos(offs[n], 2));
+					if (max != 0 && results.size() >= max) return true;
+				}
+				return false;
+			};
+			if (resolve_cached()) return;
+
+			/* The trie's top level lists every visible grandchild, by name. */
+			if (p_qualified_names)
 			{
-				hit_in_cache.insert(i_cached->second);
-				recurse(pos(i_cached->second, 2));
-				if (max != 0 && results.size() >= max) return;
+				const std::vector<Dwarf_Off>& offs
+				 = p_qualified_names->visible_grandchildren_named(wanted);
+				for (unsigned n = 0; n < offs.size(); ++n)
+				{
+					if (hit_in_cache.find(offs[n]) != hit_in_cache.end()) continue;
+					recurse(pos(offs[n], 2));
+					if (max != 0 && results.size() >= max) return;
+				}
+				return;
 			}
 
 			/* Now we have to be exhaustive. But don't bother if we know that 
 			 * our cache is exhaustive. */
 			if (!visible_named_grandchildren_is_complete)
 			{
-				auto vg_seq = visible_named_grandchildren();
-				for (auto i_g = std::move(vg_seq.first); i_g != vg_seq.second; ++i_g)
+				/* Before indexing, try the producer's name tables. Their
+				 * candidates get cached, so each is only checked once. Any
+				 * candidate that checks out is a definitive hit. */
+				load_name_tables();
+				name_atom atom = find_name_atom(wanted);
+				auto matching_tabled = name_table_offsets.equal_range(atom);
+				for (auto i_tabled = matching_tabled.first;
+					i_tabled != matching_tabled.second;
+					++i_tabled)
 				{
-					// skip any with the wrong name.
-					if (!i_g.name_here() || *i_g.name_here() != *path_pos) continue;
-					
-					/* skip any we saw before.  */
-					if (hit_in_cache.find(i_g.offset_here()) != hit_in_cache.end()) continue;
-
-					/* It's visible; use resolve_all from hereon. */
-					recurse(i_g);
+					if (hit_in_cache.find(i_tabled->second) != hit_in_cache.end()) continue;
+					/* The tables may be stale or bogus, so don't pos() blindly. */
+					auto where = locate(i_tabled->second);
+					if (!where || where->first != 2) continue;
+					iterator_base i = pos(i_tabled->second, where->first, where->second);
+					if (!i || i.name_ref_here() != wanted || !i.global_name_here()) continue;
+					hit_in_cache.insert(i_tabled->second);
+					cache_visible_named_grandchild(atom, i_tabled->second);
+					recurse(i);
 					if (max != 0 && results.size() >= max) return;
 				}
+
+				/* A .debug_names covering every CU has listed every definition
+				 * with this name, so we've now seen all we're going to, unless
+				 * our policy says to look for what DWARF 5 leaves out of it.
+				 * Otherwise, i.e. with only pubnames and pubtypes, with an
+				 * index that misses some CUs, or none at all, a miss or an
+				 * all-results query still needs the full scan. */
+				if (name_tables_complete && name_tables_answer_misses()) return;
+				index_visible_named_grandchildren();
+				resolve_cached();
 			}
 		}
 
@@ -243,11 +305,23 @@ namespace dwarf
 			if (found != live_dies.end())
 			{
 				// it's there, so use find_upwards to get the iterator
-				return iterator_base(*found->second);
+				if (!opt_depth && found->second->d.handle)
+				{
+					auto located = locate_in_cu(off, found->second->get_enclosing_cu_offset());
+					if (located) opt_depth = located->first;
+				}
+				return iterator_base(*found->second, opt_depth);
 			}
 			
 			Die h(*this, off);
 			assert(h.handle.get());
+			/* If we're not told where we are, the CU's offset index can
+			 * tell us, which saves anyone searching for our depth later. */
+			if (!opt_depth && !parent_off)
+			{
+				auto located = locate_in_cu(off, h.enclosing_cu_offset_here());
+				if (located) { opt_depth = located->first; parent_off = located->second; }
+			}
 			iterator_base base(std::move(h), opt_depth, *this);
 			
 			if (opt_depth && *opt_depth == 1) parent_of[off] = 0UL;
@@ -12,9 +12,13 @@
 #include <iostream>
 #include <utility>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <deque>
+#include <vector>
+#include <memory>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/functional/hash.hpp>
 #include <srk31/selective_iterator.hpp>
 #include <srk31/transform_iterator.hpp>
 #include <srk31/concatenating_iterator.hpp>
@@ -24,12 +28,14 @@
 #include "abstract.hpp"
 #include "libdwarf.hpp"
 #include "libdwarf-handles.hpp"
+#include "expr.hpp"
 
 namespace dwarf
 {
 	using std::string;
 	using std::map;
 	using std::unordered_map;
+	using std::unordered_multimap;
 	using std::pair;
 	using std::make_pair;
 	using std::multimap;
@@ -40,6 +46,16 @@ namespace dwarf
 	namespace core
 	{
 		struct FrameSection;
+		class qualified_name_index;
+		class address_index;
+		class static_data_index;
+		class cu_range_index;
+		class inline_frame_index;
+		class line_table;
+		class type_name_index;
+		class symbol_index;
+		class name_dictionary;
+		class demangled_name_index;
 		// iterators: forward decls
 		template <typename Iter> struct sequence;
 		std::ostream& operator<<(std::ostream& s, const iterator_base& it);
@@ -222,6 +238,15 @@ namespace dwarf
 			opt<Dwarf_Off> cached_parent_off;
 			opt<Dwarf_Off> cached_first_child_off;
 			opt<Dwarf_Off> cached_next_sibling_off;
+			/* The attributes as seen through abstract_origin / specification /
+			 * declaration links, i.e. what find_all_attrs() returns. Filled on
+			 * first use if the root's policy allows; goes away with the payload. */
+			mutable std::unique_ptr<encap::attribute_map> cached_found_attrs;
+			/* Where find_attr() looks when we lack an attribute: the link we
+			 * follow (DW_AT_abstract_origin, DW_AT_specification, or
+			 * DW_AT_declaration for a found definition; 0 for none) and its
+			 * target offset. Cached under the same policy as the above. */
+			mutable opt<pair<Dwarf_Half, Dwarf_Off> > cached_attr_link;
 			
 			/* We define an overridable *interface* for attribute access. */
 			// helper
@@ -236,6 +261,10 @@ namespace dwarf
 			virtual encap::attribute_map find_all_attrs() const;
 			// get a single attr, seeing through abstract_origin / specification links
 			virtual encap::attribute_value find_attr(Dwarf_Half a) const;
+			// helper: find_all_attrs() without the cache
+			encap::attribute_map compute_found_attrs() const;
+			// helper: the link find_attr() follows, as cached_attr_link
+			pair<Dwarf_Half, Dwarf_Off> attr_link() const;
 			virtual root_die& get_root() const // NOT defaulted!
 			{
 				assert(d.handle);
@@ -274,6 +303,8 @@ namespace dwarf
 			}
 			inline unique_ptr<const char, string_deleter> get_raw_name() const
 			{ assert(d.handle); return d.name_here(); }
+			inline name_ref get_name_ref() const
+			{ assert(d.handle); return d.name_ref_here(); }
 			inline Dwarf_Off get_enclosing_cu_offset() const 
 			{ assert(d.handle); return d.enclosing_cu_offset_here(); }
 			/* The same as all_attrs, but comes from abstract_die. 
@@ -353,6 +384,11 @@ namespace dwarf
 			typedef intrusive_ptr<basic_die> ptr_type;
 			Debug dbg;
 			
+			/* Shared location lists; see loclist_pool. Pooled loclists are
+			 * reference-counted, so attribute_values copied out of this root
+			 * stay valid after it is destructed. */
+			encap::loclist_pool loc_pool;
+			
 			/* live DIEs -- any basic DIE that is instantiated registers itself here,
 			 * and deregisters itself when it is destructed.
 			 * This must be destructed *after* the sticky set, i.e. declared before it,
@@ -375,14 +411,97 @@ namespace dwarf
 			map<Dwarf_Off, opt<uint32_t> > type_summary_code_cache; // FIXME: delete this after summary_code() uses SCCs
 			opt<Dwarf_Off> synthetic_cu;
 
-			multimap<string, Dwarf_Off> visible_named_grandchildren_cache;
+		public:
+			/* Names can be interned, per root, to small integers ("atoms"),
+			 * so that name-keyed caches compare and hash integers rather
+			 * than strings. Atom 0 stands for "no name". */
+			typedef unsigned name_atom;
+			static constexpr name_atom NO_NAME_ATOM = 0;
+			name_atom intern_name(name_ref n);
+			// lookup only: NO_NAME_ATOM if n has never been interned
+			name_atom find_name_atom(name_ref n) const;
+			name_ref name_for_atom(name_atom a) const;
+			name_atom name_atom_here(const iterator_base& i);
+		protected:
+			struct name_ref_hash
+			{
+				size_t operator()(name_ref n) const
+				{ return boost::hash_range(n.begin(), n.end()); }
+			};
+			/* We take our own copy of each distinct name, since in-memory
+			 * DIEs can be renamed. A deque doesn't move its elements, so
+			 * the name_refs used as keys stay good. */
+			deque<string> interned_names; // atom n is at index n - 1
+			unordered_map<name_ref, name_atom, name_ref_hash> name_atoms;
+
+			/* Most names have one or two visible grandchildren, so a short
+			 * vector per name beats a node per (name, offset) pair. */
+			unordered_map<name_atom, std::vector<Dwarf_Off> > visible_named_grandchildren_cache;
 			bool visible_named_grandchildren_is_complete;
+			void cache_visible_named_grandchild(name_atom a, Dwarf_Off off);
+			/* What the producer's name tables (pubnames, pubtypes, and DWARF 5's
+			 * .debug_names) say, loaded on first use. They can point at DIEs
+			 * that aren't grandchildren at all, so each offset is only a
+			 * candidate for the cache above. Pubnames and pubtypes only cover
+			 * some of the visible grandchildren. A .debug_names covering every
+			 * CU has all the definitions, so can also tell us what *isn't*
+			 * there; see name_tables_answer_misses(). */
+			unordered_multimap<name_atom, Dwarf_Off> name_table_offsets;
+			bool name_tables_loaded;
+			bool name_tables_complete; // a .debug_names covers every CU
+			void load_name_tables();
+			bool load_debug_names(std::set<Dwarf_Off>& cus_covered);
+
+			/* Per-scope child name indexes, for find_named_child. These are
+			 * kept here, keyed by the scope's offset, rather than in its
+			 * payload, so they outlive the payload. A scope with only a few
+			 * children is just marked as such, and searched linearly. */
+			struct child_name_index
+			{
+				bool linear;
+				unordered_map<name_atom, Dwarf_Off> first_named; // first, as in a linear search
+			};
+			static constexpr unsigned MIN_HASHED_CHILDREN = 16;
+			unordered_map<Dwarf_Off, child_name_index> child_name_indexes;
+			void forget_child_names(Dwarf_Off scope_off) { child_name_indexes.erase(scope_off); }
 			friend class in_memory_abstract_die::attribute_map;
 
 			FrameSection *p_fs;
+			std::unique_ptr<qualified_name_index> p_qualified_names; // only if someone asked for it
+			void forget_qualified_names();
+			std::unique_ptr<address_index> p_address_index; // likewise
+			void forget_address_index();
+			std::unique_ptr<inline_frame_index> p_inline_frames; // likewise; refers to *p_address_index, so declared after it
+			void forget_inline_frames();
+			std::unique_ptr<cu_range_index> p_cu_ranges; // likewise
+			void forget_cu_ranges();
+			std::unique_ptr<static_data_index> p_static_data_index; // likewise
+			void forget_static_data_index();
+			std::unique_ptr<type_name_index> p_type_names; // likewise
+			void forget_type_names();
+			std::unique_ptr<symbol_index> p_symbols; // likewise
+			void forget_symbol_dies(); // the ELF symbols don't change, only their DIEs
+			std::unique_ptr<name_dictionary> p_name_dictionary; // likewise
+			void forget_name_dictionary();
+			std::unique_ptr<demangled_name_index> p_demangled_names; // likewise
+			void forget_demangled_names();
 			Dwarf_Off current_cu_offset; // 0 means none
 			::Elf *returned_elf;
+			/* For building indexes on worker threads, each of which opens
+			 * the file again with its own WorkerDebug. */
+			int opened_fd; // -1 if we weren't opened from an fd
+			unsigned index_workers; // 0 means hardware_workers()
+			bool has_in_memory_dies() const;
 		public:
+			/* How many threads index building may use: 1, meaning only the
+			 * calling thread, unless we were opened from an fd and have no
+			 * in-memory DIEs, which a WorkerDebug couldn't see. */
+			unsigned index_worker_count() const;
+			/* ... and how many, for work that doesn't touch libdwarf. */
+			unsigned index_thread_limit() const
+			{ return index_workers ? index_workers : hardware_workers(); }
+			int get_opened_fd() const { return opened_fd; }
+			void set_index_workers(unsigned n) { index_workers = n; }
 			FrameSection&       get_frame_section()       { assert(p_fs); return *p_fs; }
 			const FrameSection& get_frame_section() const { assert(p_fs); return *p_fs; }
 		protected:
@@ -391,6 +510,15 @@ namespace dwarf
 			virtual iterator_df<compile_unit_die> get_or_create_synthetic_cu();
 			virtual iterator_base make_new(const iterator_base& parent, Dwarf_Half tag);
 			virtual bool is_sticky(const abstract_die& d);
+			/* Policy for caching find_all_attrs() in the payload. */
+			virtual bool caches_found_attrs(const basic_die& d);
+			/* Policy for whether, given a .debug_names covering every CU,
+			 * resolve_all_visible_from_root() trusts it for misses and for
+			 * all-results queries, rather than scanning every CU's children.
+			 * DWARF 5 leaves out declarations, and variables and subprograms
+			 * with no address, so those are then not found by name from the
+			 * root. Subclasses that need them should return false. */
+			virtual bool name_tables_answer_misses();
 			
 			void get_referential_structure(
 				unordered_map<Dwarf_Off, Dwarf_Off>& parent_of,
@@ -401,8 +529,7 @@ namespace dwarf
 			virtual Dwarf_Off fresh_offset_under(const iterator_base& pos);
 		
 		public:
-			root_die() : dbg(), visible_named_grandchildren_is_complete(false), p_fs(nullptr),
-				current_cu_offset(0), returned_elf(nullptr) {}
+			root_die(); // out of line, where the indexes' types are complete
 			root_die(int fd);
 			virtual ~root_die();
 		
@@ -503,10 +630,51 @@ namespace dwarf
 			Iter find_downwards(Dwarf_Off off);		
 			template <typename Iter = iterator_df<> >
 			Iter find_upwards(Dwarf_Off off, ptr_type maybe_ptr = nullptr);
+
+		private: // pos() helpers
+			/* Following a reference gives us only an offset. Rather than
+			 * searching for the target's depth and parent, we walk its CU
+			 * once, recording every DIE's depth and parent. DIEs are laid out
+			 * in preorder, so the offsets come out sorted and we can binary-
+			 * search them. Only libdwarf-backed DIEs are indexed. */
+			struct cu_offset_index
+			{
+				std::vector<Dwarf_Off> offsets;
+				std::vector<Dwarf_Off> parents;
+				std::vector<unsigned short> depths;
+				bool refs_indexed;
+				cu_offset_index() : refs_indexed(false) {}
+			};
+			map<Dwarf_Off, cu_offset_index> cu_offset_indexes; // keyed on CU offset
+			cu_offset_index& offset_index_for_cu(Dwarf_Off cu_off);
+			/* The walk itself needs only a libdwarf handle, not the root,
+			 * so that worker threads can do it on their own handles. If
+			 * p_refs is given, each reference attribute is appended to it. */
+			typedef std::vector<pair<pair<Dwarf_Off, Dwarf_Half>, Dwarf_Off> > ref_list;
+			static void index_cu_subtree(Dwarf_Debug raw_dbg, Die::handle_type first,
+				Dwarf_Off parent_off, unsigned short depth, cu_offset_index& idx, ref_list *p_refs);
+			static void index_cu(Dwarf_Debug raw_dbg, Dwarf_Off cu_off,
+				cu_offset_index& idx, ref_list *p_refs);
+			/* Depth and parent offset, if off is a DIE in the CU at cu_off. */
+			opt<pair<unsigned short, Dwarf_Off> > locate_in_cu(Dwarf_Off off, Dwarf_Off cu_off);
+			/* Ditto, if off is a DIE in any CU. Unlike pos(), this copes with
+			 * offsets we can't trust, e.g. from the producer's name tables. */
+			opt<pair<unsigned short, Dwarf_Off> > locate(Dwarf_Off off);
+		public:
+			/* Fill refers_to for every reference attribute in the CU, in one
+			 * pass, rather than one search per reference followed. */
+			void index_references_in_cu(Dwarf_Off cu_off);
+			/* ... and in every CU, plus any in-memory DIEs. The CUs are
+			 * spread over index_worker_count() threads. */
+			void index_all_references();
+			/* Once indexed, the forward references, keyed on (source, attr). */
+			const map<pair<Dwarf_Off, Dwarf_Half>, Dwarf_Off>& get_refers_to() const
+			{ return refers_to; }
 			
 		public:
 			::Elf *get_elf(); // hmm: lib-only?
 			Debug& get_dbg() { return dbg; }
+			encap::loclist_pool& get_loclist_pool() { return loc_pool; }
 
 			// iterator navigation primitives
 			// note: want to avoid virtual dispatch on these
@@ -523,13 +691,47 @@ namespace dwarf
 			 * call a method on the *iterator* (which knows whether it has payload).
 			 * It's okay to implement resolve() et al here, because they will call
 			 * into the iterator method.
-			 * BUT we do put a special find_named_child method, emphasising the linear
-			 * search (slow). This is the fallback implementation used by the iterator.
+			 * BUT we do put a special find_named_child method. This is the fallback
+			 * implementation used by the iterator. It used to be a linear search;
+			 * now it builds a hashed index of the scope's children on first use.
 			 */
 			iterator_base find_named_child(const iterator_base& start, const string& name);
 			/* This one is only for searches anchored at the root, so no need for "start". */
 			iterator_base find_visible_grandchild_named(const string& name);
 			std::vector<iterator_base> find_all_visible_grandchildren_named(const string& name);
+			/* Fill the visible-grandchildren cache in one go, rather than as a
+			 * side-effect of iterating. Lookups after this are a hash probe. */
+			void index_visible_named_grandchildren();
+			/* Build, if need be, the trie of qualified names (qualified-names.hpp).
+			 * Once it's built, the resolve functions answer from it. */
+			const qualified_name_index& get_qualified_name_index();
+			/* Build, if need be, the index from code addresses to DIEs
+			 * (address-index.hpp). */
+			const address_index& get_address_index();
+			/* ... and, more cheaply, from code addresses to CUs, using
+			 * .debug_aranges where we can. */
+			const cu_range_index& get_cu_range_index();
+			iterator_df<compile_unit_die> cu_for_pc(Dwarf_Addr file_relative_addr);
+			/* ... and to the stack of inlined calls there (inline-frames.hpp). */
+			const inline_frame_index& get_inline_frame_index();
+			/* ... and from static data addresses to variables. */
+			const static_data_index& get_static_data_index();
+			/* Decode every CU's line table now, rather than each on first
+			 * use, sharing the CUs out among index_worker_count() threads. */
+			void load_line_tables();
+			/* Build, if need be, the index of named types by qualified name
+			 * and tag (type-names.hpp). find_definition() doesn't use it;
+			 * callers wanting definitions from other CUs ask it directly. */
+			const type_name_index& get_type_name_index();
+			/* Build, if need be, the index of ELF symbols, joined with the
+			 * DIEs (symbols.hpp). */
+			const symbol_index& get_symbol_index();
+			/* Build, if need be, the sorted dictionary of all DIE names, for
+			 * prefix, glob and regex searches (name-dictionary.hpp). */
+			const name_dictionary& get_name_dictionary();
+			/* Build, if need be, the index of subprograms and variables by
+			 * demangled name (demangled-names.hpp). */
+			const demangled_name_index& get_demangled_name_index();
 			
 			bool is_under(const iterator_base& i1, const iterator_base& i2);
 			
@@ -0,0 +1,255 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * small-map.hpp: a sorted, flat map with inline storage for small sizes.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_SMALL_MAP_HPP_
+#define DWARFPP_SMALL_MAP_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace dwarf
+{
+	namespace encap
+	{
+		/* A map which keeps its elements sorted in a single array, the first
+		 * N of which live inside the object itself. It's intended for things
+		 * like a DIE's attributes, of which there are usually a handful, and
+		 * where a node-based std::map spends more on allocation than it ever
+		 * saves on lookup.
+		 *
+		 * We present the subset of std::map's interface that our clients use.
+		 * The value_type is the same as std::map's, i.e. the key is const.
+		 * Since that means elements can't be assigned, we move them around by
+		 * construct-and-destroy, so V should be cheaply move-constructible, and
+		 * must be nothrow move-constructible: that is what lets insert() and
+		 * erase() shuffle elements without any way to fail half-way. Copying
+		 * V may throw; insert() copies before it touches the array, so a
+		 * failed insert leaves the map as it was.
+		 * Unlike std::map, insert() and erase() invalidate iterators. */
+		template <typename K, typename V, unsigned N>
+		class small_sorted_map
+		{
+		public:
+			typedef K key_type;
+			typedef V mapped_type;
+			typedef std::pair<const K, V> value_type;
+			typedef value_type& reference;
+			typedef const value_type& const_reference;
+			typedef value_type *iterator;
+			typedef const value_type *const_iterator;
+			typedef std::size_t size_type;
+			static_assert(std::is_nothrow_move_constructible<value_type>::value,
+				"small_sorted_map relocates elements by moving them");
+		private:
+			typedef typename std::aligned_storage<sizeof (value_type), alignof (value_type)>::type
+				slot_type;
+			value_type *m_elems;
+			unsigned m_size;
+			unsigned m_capacity;
+			slot_type m_inline[N];
+
+			value_type *inline_elems()
+			{ return reinterpret_cast<value_type *>(&m_inline[0]); }
+			bool is_inline() const
+			{ return m_elems == reinterpret_cast<const value_type *>(&m_inline[0]); }
+
+			static void relocate(value_type *from, value_type *to)
+			{
+				new (to) value_type(std::move(*from));
+				from->~value_type();
+			}
+			void reserve_for(unsigned wanted)
+			{
+				if (wanted <= m_capacity) return;
+				unsigned new_capacity = std::max(wanted, 2 * m_capacity);
+				value_type *new_elems = static_cast<value_type *>(
+					::operator new(new_capacity * sizeof (value_type)));
+				for (unsigned i = 0; i < m_size; ++i) relocate(&m_elems[i], &new_elems[i]);
+				if (!is_inline()) ::operator delete(m_elems);
+				m_elems = new_elems;
+				m_capacity = new_capacity;
+			}
+			/* Open a hole at index pos, which the caller must fill. */
+			value_type *make_hole(unsigned pos)
+			{
+				reserve_for(m_size + 1);
+				for (unsigned i = m_size; i > pos; --i) relocate(&m_elems[i - 1], &m_elems[i]);
+				++m_size;
+				return &m_elems[pos];
+			}
+			static bool key_less(const value_type& v, const K& k) { return v.first < k; }
+			static bool less_key(const K& k, const value_type& v) { return k < v.first; }
+			void copy_from(const small_sorted_map& other)
+			{
+				reserve_for(other.m_size);
+				for (unsigned i = 0; i < other.m_size; ++i)
+				{
+					new (&m_elems[i]) value_type(other.m_elems[i]);
+					++m_size; // keep m_size honest in case a copy throws
+				}
+			}
+			void steal_from(small_sorted_map& other)
+			{
+				if (other.is_inline())
+				{
+					for (unsigned i = 0; i < other.m_size; ++i)
+					{
+						relocate(&other.m_elems[i], &m_elems[i]);
+					}
+					m_size = other.m_size;
+				}
+				else
+				{
+					m_elems = other.m_elems;
+					m_size = other.m_size;
+					m_capacity = other.m_capacity;
+					other.m_elems = other.inline_elems();
+					other.m_capacity = N;
+				}
+				other.m_size = 0;
+			}
+			void release()
+			{
+				clear();
+				if (!is_inline()) ::operator delete(m_elems);
+				m_elems = inline_elems();
+				m_capacity = N;
+			}
+		public:
+			small_sorted_map() : m_elems(inline_elems()), m_size(0), m_capacity(N) {}
+			small_sorted_map(const small_sorted_map& other)
+			 : m_elems(inline_elems()), m_size(0), m_capacity(N)
+			{ copy_from(other); }
+			small_sorted_map(small_sorted_map&& other)
+			 : m_elems(inline_elems()), m_size(0), m_capacity(N)
+			{ steal_from(other); }
+			small_sorted_map& operator=(const small_sorted_map& other)
+			{
+				if (&other != this) { clear(); copy_from(other); }
+				return *this;
+			}
+			small_sorted_map& operator=(small_sorted_map&& other)
+			{
+				if (&other != this) { release(); steal_from(other); }
+				return *this;
+			}
+			~small_sorted_map() { release(); }
+
+			iterator begin() { return m_elems; }
+			iterator end() { return m_elems + m_size; }
+			const_iterator begin() const { return m_elems; }
+			const_iterator end() const { return m_elems + m_size; }
+			const_iterator cbegin() const { return begin(); }
+			const_iterator cend() const { return end(); }
+			size_type size() const { return m_size; }
+			bool empty() const { return m_size == 0; }
+			void reserve(size_type n) { reserve_for(n); }
+
+			void clear()
+			{
+				for (unsigned i = 0; i < m_size; ++i) m_elems[i].~value_type();
+				m_size = 0;
+			}
+
+			iterator lower_bound(const K& k)
+			{ return std::lower_bound(begin(), end(), k, key_less); }
+			const_iterator lower_bound(const K& k) const
+			{ return std::lower_bound(begin(), end(), k, key_less); }
+			iterator upper_bound(const K& k)
+			{ return std::upper_bound(begin(), end(), k, less_key); }
+			const_iterator upper_bound(const K& k) const
+			{ return std::upper_bound(begin(), end(), k, less_key); }
+			iterator find(const K& k)
+			{
+				iterator found = lower_bound(k);
+				return (found != end() && !(k < found->first)) ? found : end();
+			}
+			const_iterator find(const K& k) const
+			{
+				const_iterator found = lower_bound(k);
+				return (found != end() && !(k < found->first)) ? found : end();
+			}
+			std::pair<iterator, iterator> equal_range(const K& k)
+			{ iterator found = find(k); return std::make_pair(found, found == end() ? found : found + 1); }
+			std::pair<const_iterator, const_iterator> equal_range(const K& k) const
+			{ const_iterator found = find(k); return std::make_pair(found, found == end() ? found : found + 1); }
+			size_type count(const K& k) const { return find(k) != end(); }
+			V& at(const K& k)
+			{
+				iterator found = find(k);
+				if (found == end()) throw std::out_of_range("small_sorted_map::at");
+				return found->second;
+			}
+			const V& at(const K& k) const
+			{
+				const_iterator found = find(k);
+				if (found == end()) throw std::out_of_range("small_sorted_map::at");
+				return found->second;
+			}
+
+			/* Attributes mostly arrive in increasing order, so we check the
+			 * back before doing the binary search. */
+			std::pair<iterator, bool> insert(const value_type& val)
+			{
+				iterator pos = (m_size == 0 || m_elems[m_size - 1].first < val.first)
+					? end() : lower_bound(val.first);
+				if (pos != end() && !(val.first < pos->first)) return std::make_pair(pos, false);
+				/* Copy first, since that may throw; nothing after it can,
+				 * except growing the array, which leaves us untouched. */
+				value_type copy(val);
+				value_type *hole = make_hole(pos - begin());
+				new (hole) value_type(std::move(copy));
+				return std::make_pair(hole, true);
+			}
+			std::pair<iterator, bool> insert(value_type&& val)
+			{
+				iterator pos = (m_size == 0 || m_elems[m_size - 1].first < val.first)
+					? end() : lower_bound(val.first);
+				if (pos != end() && !(val.first < pos->first)) return std::make_pair(pos, false);
+				value_type *hole = make_hole(pos - begin());
+				new (hole) value_type(std::move(val));
+				return std::make_pair(hole, true);
+			}
+			/* The hint is only a hint; as with std::map, we return the
+			 * element with the same key if one is already present. */
+			iterator insert(const_iterator hint, const value_type& val)
+			{
+				return insert(val).first;
+			}
+			template <typename... Args>
+			std::pair<iterator, bool> emplace(Args&&... args)
+			{
+				return insert(value_type(std::forward<Args>(args)...));
+			}
+
+			iterator erase(const_iterator pos)
+			{
+				assert(pos >= begin() && pos < end());
+				unsigned idx = pos - begin();
+				m_elems[idx].~value_type();
+				for (unsigned i = idx + 1; i < m_size; ++i) relocate(&m_elems[i], &m_elems[i - 1]);
+				--m_size;
+				return m_elems + idx;
+			}
+			size_type erase(const K& k)
+			{
+				iterator found = find(k);
+				if (found == end()) return 0;
+				erase(found);
+				return 1;
+			}
+		};
+	}
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include <cassert>
 #include <algorithm>
 #include <type_traits>
+#include <memory>
 
 /* Basic idea of this file: 
  *
@@ -75,13 +76,34 @@ namespace dwarf
 			
 			virtual int get_explicit_interp(int attr, int form) const = 0;
 			virtual int get_interp(int attr, int form) const = 0;
-			
+
+			/* Like get_interp, but memoised in a dense (attr, form) table
+			 * owned by this def. Attribute decoding calls this for every
+			 * attribute it reads, so the common case must be one load.
+			 * Attributes are numbered either in the standard range or in
+			 * the vendor range starting at DW_AT_lo_user; forms in the
+			 * standard range only. Anything else goes to get_interp(). */
+			inline int interp_for(int attr, int form) const;
+
 			virtual const char *interp_lookup(int interp) const = 0;
-			
+
 			friend std::ostream& operator<<(std::ostream& o, const abstract_def& a);
 			virtual std::ostream& print(std::ostream& o) const = 0;
-			
+
+			abstract_def() = default;
+			/* A copy gets its own table, filled in afresh. */
+			abstract_def(const abstract_def&) {}
+			abstract_def& operator=(const abstract_def&) { return *this; }
 			virtual ~abstract_def() {}
+		private:
+			static const int INTERP_TABLE_STD_ATTRS = 0x80;
+			static const int INTERP_TABLE_USER_ATTRS = 0x200; // from DW_AT_lo_user
+			static const int INTERP_TABLE_FORMS = 0x40;
+			static const unsigned char INTERP_NOT_YET = 0xff;
+			/* Allocated on first use, so that we don't depend on static init
+			 * order w.r.t. the maps that get_interp() consults. */
+			mutable std::unique_ptr<unsigned char[]> interp_table;
+			unsigned char *make_interp_table() const;
 		};
 		typedef abstract_def spec;
 		struct string_comparator
@@ -442,7 +464,30 @@ namespace dwarf
 
 		// standalone helper
 		int explicit_interp(abstract_def& def, int attr, const int *attr_possible_classes, int form, const int *form_possible_classes);
-	
+
+		inline int abstract_def::interp_for(int attr, int form) const
+		{
+			int attr_idx;
+			if (attr >= 0 && attr < INTERP_TABLE_STD_ATTRS) attr_idx = attr;
+			else if (attr >= DW_AT_lo_user && attr < DW_AT_lo_user + INTERP_TABLE_USER_ATTRS)
+			{
+				attr_idx = INTERP_TABLE_STD_ATTRS + (attr - DW_AT_lo_user);
+			}
+			else return get_interp(attr, form);
+			if (form < 0 || form >= INTERP_TABLE_FORMS) return get_interp(attr, form);
+
+			unsigned char *table = interp_table ? interp_table.get() : make_interp_table();
+			unsigned char& entry = table[attr_idx * INTERP_TABLE_FORMS + form];
+			if (__builtin_expect(entry != INTERP_NOT_YET, 1)) return entry;
+
+			/* First time we've seen this pair. Interps carry no flag bits
+			 * by the time get_interp() returns them, so they fit in a byte;
+			 * if one ever doesn't, just don't memoise it. */
+			int cls = get_interp(attr, form);
+			if (cls >= 0 && cls < INTERP_NOT_YET) entry = static_cast<unsigned char>(cls);
+			return cls;
+		}
+
 		void print_symmetric_map_pair(
 			std::ostream& o,
 			const std::map<const char *, int>& forward_map,
@@ -0,0 +1,69 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * symbolize.hpp: many addresses to functions, inlined calls and lines.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_SYMBOLIZE_HPP_
+#define DWARFPP_SYMBOLIZE_HPP_
+
+#include <vector>
+#include <utility>
+
+#include "root.hpp"
+#include "inline-frames.hpp"
+#include "line-table.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::pair;
+
+		/* Profilers give us samples by the million, mostly in a few hot
+		 * places. A batch_symbolization sorts and deduplicates them, then
+		 * walks them in address order. The address_index, and each line
+		 * table, tell us how far their answer for one address holds, so
+		 * neighbouring addresses reuse it rather than searching again.
+		 * The inline stack for each distinct innermost DIE is stored once
+		 * and shared by every address under it, even when that DIE's
+		 * ranges are split into several segments.
+		 *
+		 * Addresses are file-relative, as elsewhere. Results come back in
+		 * the order the addresses were given. */
+		class batch_symbolization
+		{
+		public:
+			struct result
+			{
+				Dwarf_Addr addr;
+				Dwarf_Off cu;       // 0 if none
+				Dwarf_Off function; // the concrete subprogram, or 0 if none
+				/* The inlined calls and the subprogram, innermost first, as
+				 * [first_frame, first_frame + nframes) in frames(). */
+				unsigned first_frame;
+				unsigned nframes;
+				opt<line_table::row> line;
+			};
+		private:
+			vector<result> m_results;
+			vector<inline_frame_index::frame> m_frames;
+			unsigned ndistinct;
+		public:
+			batch_symbolization(root_die& r, const vector<Dwarf_Addr>& addrs);
+
+			const vector<result>& results() const { return m_results; }
+			const vector<inline_frame_index::frame>& frames() const { return m_frames; }
+			pair<const inline_frame_index::frame *, const inline_frame_index::frame *>
+			inline_chain(const result& res) const
+			{ return std::make_pair(m_frames.data() + res.first_frame,
+				m_frames.data() + res.first_frame + res.nframes); }
+			unsigned distinct_addresses() const { return ndistinct; }
+		};
+	}
+}
+
+#endif
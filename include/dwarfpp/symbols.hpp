@@ -0,0 +1,99 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * symbols.hpp: the ELF symbol tables, joined with the DIEs.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_SYMBOLS_HPP_
+#define DWARFPP_SYMBOLS_HPP_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "root.hpp"
+#include "iter.hpp"
+#include "dies.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+
+		/* Declarations whose address is only in the symbol table, like
+		 * extern variables, are located by a sym_resolver_t, and every
+		 * client used to write its own, searching the symtab linearly. The
+		 * symbol_index reads .symtab and .dynsym once, through the root's
+		 * Elf handle, and keeps them hashed by name and sorted by address.
+		 * Symbols in both tables are kept once, from .symtab. Addresses are
+		 * st_value as found, i.e. file-relative in an executable or
+		 * shared object, as elsewhere in libdwarfpp.
+		 *
+		 * It also joins symbols with DIEs: by linkage name (or, for C, the
+		 * name of an external subprogram or variable), else by address,
+		 * using the root's address indexes. */
+		class symbol_index
+		{
+		public:
+			typedef unsigned sym_id;
+			struct symbol
+			{
+				string name;
+				Dwarf_Addr value;
+				Dwarf_Unsigned size;
+				unsigned char type; // STT_*
+				unsigned char bind; // STB_*
+				Dwarf_Half shndx;   // SHN_UNDEF if not defined here
+				bool dynamic;       // from .dynsym but not .symtab
+			};
+		private:
+			root_die& r;
+			vector<symbol> symbols;
+			std::unordered_multimap<string, sym_id> by_name;
+			/* Defined symbols with an address, sorted by value, and the
+			 * running maximum end, as in static_data_index. */
+			vector<sym_id> by_addr;
+			vector<Dwarf_Addr> max_end;
+			/* Linkage name to DIE, for the join. Unlike the symbols, this
+			 * goes stale when DIEs are added or renamed, so it is built
+			 * when first needed and dropped by forget_dies(). */
+			mutable std::unordered_map<string, Dwarf_Off> die_by_linkage_name;
+			mutable bool linkage_names_indexed;
+
+			void read_symtab(::Elf *e, unsigned sh_type);
+			void index_linkage_names() const;
+		public:
+			explicit symbol_index(root_die& r);
+			/* Drop the join with the DIEs, keeping the symbols. */
+			void forget_dies();
+
+			const symbol& get(sym_id s) const { return symbols.at(s); }
+			unsigned size() const { return symbols.size(); }
+
+			/* The defined symbol with this name, preferring global binding. */
+			opt<sym_id> find(const string& name) const;
+			vector<sym_id> find_all(const string& name) const;
+			/* The symbol covering addr with the greatest start, preferring
+			 * sized ones; a zero-size symbol covers only its own address. */
+			opt<sym_id> covering(Dwarf_Addr addr) const;
+
+			/* The DIE describing a symbol, or END. Failing a linkage name,
+			 * a function symbol matches the subprogram starting at its
+			 * address, and an object symbol the variable starting at its. */
+			iterator_base die_for(sym_id s) const;
+			/* The symbol for a DIE with a linkage name or external name. */
+			opt<sym_id> symbol_for(const iterator_base& i) const;
+
+			/* A sym_resolver_t answering from the root's symbol index. It
+			 * stays valid as long as the root_die does. It throws No_entry for names with no
+			 * defined symbol, as resolvers do. */
+			with_static_location_die::sym_resolver_t resolver() const;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,85 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * type-names.hpp: named types across all CUs, by qualified name and tag.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#ifndef DWARFPP_TYPE_NAMES_HPP_
+#define DWARFPP_TYPE_NAMES_HPP_
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+
+#include "root.hpp"
+#include "iter.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		using std::vector;
+		using std::string;
+		using std::pair;
+
+		/* "The struct named foo" is a question analyses ask over and over.
+		 * Answering it from the visible grandchildren misses types nested
+		 * in namespaces or classes, and finds declarations as readily as
+		 * definitions. The type_name_index walks every CU once and files each
+		 * named type under its "::"-joined qualified name and its tag.
+		 * We descend into namespaces, structs, classes and unions, since
+		 * those are what a type's qualified name can be made of. Anonymous
+		 * namespaces add no component; other anonymous scopes are skipped,
+		 * since nothing can name what's in them.
+		 *
+		 * Each key keeps all its candidates, definitions before declarations,
+		 * each group in file order.
+		 *
+		 * Like the root's other indexes, it's a snapshot, dropped by the
+		 * root when in-memory DIEs are added or named. */
+		class type_name_index
+		{
+		public:
+			typedef pair<string, Dwarf_Half> key;
+		private:
+			root_die& r;
+			struct candidates
+			{
+				vector<Dwarf_Off> dies;
+				unsigned ndefinitions; // the first ndefinitions of dies
+			};
+			std::unordered_map<key, candidates, boost::hash<key> > by_key;
+			static const vector<Dwarf_Off> no_dies;
+
+			void add_children(const iterator_base& scope, const string& prefix, spec& s);
+		public:
+			explicit type_name_index(root_die& r);
+
+			/* Is this a tag whose named DIEs contribute to a qualified name? */
+			static bool tag_is_qualifying_scope(Dwarf_Half tag);
+			/* The qualified name we file a DIE under, computed from its
+			 * ancestors, or none if we would not have indexed it. */
+			static opt<string> qualified_name_for(const iterator_base& i);
+
+			/* All candidates, definitions first. */
+			const vector<Dwarf_Off>& find(const string& qualified, Dwarf_Half tag) const;
+			/* The first definition, or END if there are only declarations. */
+			iterator_base find_definition(const string& qualified, Dwarf_Half tag) const;
+			/* The first definition, else the first declaration, else END. */
+			iterator_base find_best(const string& qualified, Dwarf_Half tag) const;
+			/* A definition matching a declaration anywhere in the file.
+			 * Unlike with_data_members_die::find_definition(), which looks
+			 * only among the declaration's siblings, this may pick a type
+			 * from another CU, or another language's same-named type. */
+			iterator_base find_definition_for(const iterator_base& decl) const;
+
+			unsigned size() const { return by_key.size(); }
+		};
+	}
+}
+
+#endif
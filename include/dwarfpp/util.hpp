@@ -11,6 +11,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <functional>
 
 namespace dwarf
 {
@@ -25,6 +26,18 @@ namespace dwarf
 		}
 		#define debug_expensive(lvl, args...) \
 			((debug_level >= (lvl)) ? (debug(lvl) args) : (debug(lvl)))
+
+		/* Calls fn(item, worker) for every item in [0, count), on up to
+		 * nworkers threads, the calling thread being worker 0. Each worker
+		 * takes the next unclaimed item until none are left, so items
+		 * may be done in any order. If any call throws, we stop handing
+		 * out items and rethrow the first exception once all have
+		 * finished. With one worker, or one item, everything happens on
+		 * the calling thread. */
+		void parallel_for(unsigned count, unsigned nworkers,
+			const std::function<void(unsigned, unsigned)>& fn);
+		/* What we assume we can usefully run at once. */
+		unsigned hardware_workers();
 	}
 }
 
@@ -181,7 +181,7 @@ case DW_TAG_ ## name: \
 				auto it = r.pos(ret->get_offset(), parent.depth() + 1);
 				if (it.global_name_here())
 				{
-					r.visible_named_grandchildren_cache.insert(make_pair(*it.global_name_here(), ret->get_offset()));
+					r.cache_visible_named_grandchild(r.name_atom_here(it), ret->get_offset());
 				}
 			}
 		}
@@ -207,17 +207,50 @@ case DW_TAG_ ## name: return &dummy_ ## name;
 			attribute_map::iterator inserted
 		)
 		{
+			if (inserted->first == DW_AT_low_pc || inserted->first == DW_AT_high_pc
+				|| inserted->first == DW_AT_ranges)
+			{
+				p_owner->p_root->forget_address_index();
+				p_owner->p_root->forget_cu_ranges();
+			}
+			/* A variable's extent depends on its type, too. */
+			if (inserted->first == DW_AT_location || inserted->first == DW_AT_type)
+			{
+				p_owner->p_root->forget_static_data_index();
+			}
+			if (inserted->first == DW_AT_abstract_origin || inserted->first == DW_AT_call_file
+				|| inserted->first == DW_AT_call_line || inserted->first == DW_AT_call_column)
+			{
+				p_owner->p_root->forget_inline_frames();
+			}
+			if (inserted->first == DW_AT_declaration)
+			{
+				p_owner->p_root->forget_type_names();
+				p_owner->p_root->forget_symbol_dies();
+			}
+			if (inserted->first == DW_AT_linkage_name || inserted->first == DW_AT_MIPS_linkage_name
+				|| inserted->first == DW_AT_external)
+			{
+				p_owner->p_root->forget_symbol_dies();
+				p_owner->p_root->forget_demangled_names();
+			}
 			if (inserted->first == DW_AT_name)
 			{
 				auto found = p_owner->p_root->pos(p_owner->m_offset);
 				assert(found);
+				p_owner->p_root->forget_child_names(found.parent().offset_here());
+				p_owner->p_root->forget_qualified_names();
+				p_owner->p_root->forget_type_names();
+				p_owner->p_root->forget_symbol_dies();
+				p_owner->p_root->forget_name_dictionary();
+				p_owner->p_root->forget_demangled_names();
 				if (found.depth() == 2 && found.global_name_here())
 				{
 					// we can either invalidate the whole thing...
 					// this->visible_named_grandchildren_is_complete = false;
 					// ... or we can preserve the completeness invariant if it holds!
-					p_owner->p_root->visible_named_grandchildren_cache.insert(
-						make_pair(*found.name_here(), p_owner->m_offset)
+					p_owner->p_root->cache_visible_named_grandchild(
+						p_owner->p_root->name_atom_here(found), p_owner->m_offset
 					);
 				}
 			}
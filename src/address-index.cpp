@@ -0,0 +1,397 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * address-index.cpp: from addresses to the DIEs that cover them.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/dies.hpp"
+#include "dwarfpp/dies-inl.hpp"
+#include "dwarfpp/address-index.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		constexpr address_index::node_id address_index::NO_NODE;
+
+		bool address_index::tag_has_code_ranges(Dwarf_Half tag)
+		{
+			switch (tag)
+			{
+				case DW_TAG_compile_unit:
+				case DW_TAG_partial_unit:
+				case DW_TAG_subprogram:
+				case DW_TAG_entry_point:
+				case DW_TAG_lexical_block:
+				case DW_TAG_inlined_subroutine:
+				case DW_TAG_try_block:
+				case DW_TAG_catch_block:
+				case DW_TAG_with_stmt:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		/* This follows the code-range cases of
+		 * with_static_location_die::file_relative_intervals, but works on
+		 * DIEs that aren't with_static_location_dies, like lexical blocks,
+		 * and doesn't need their payloads. */
+		void address_index::intervals_here(root_die& r, const iterator_base& i,
+			vector<pair<Dwarf_Addr, Dwarf_Addr> >& out)
+		{
+			if (i.has_attr_here(DW_AT_ranges))
+			{
+				iterator_df<compile_unit_die> i_cu = r.cu_pos(i.enclosing_cu_offset_here());
+				auto rangelist = i_cu->normalize_rangelist(i.attr(DW_AT_ranges).get_rangelist());
+				for (auto i_r = rangelist.begin(); i_r != rangelist.end(); ++i_r)
+				{
+					if (i_r->dwr_type == DW_RANGES_ENTRY && i_r->dwr_addr2 > i_r->dwr_addr1)
+					{
+						out.push_back(make_pair(i_r->dwr_addr1, i_r->dwr_addr2));
+					}
+				}
+			}
+			else if (i.has_attr_here(DW_AT_low_pc) && i.has_attr_here(DW_AT_high_pc))
+			{
+				Dwarf_Addr lopc = i.attr(DW_AT_low_pc).get_address().addr;
+				encap::attribute_value high = i.attr(DW_AT_high_pc);
+				// DWARF 4 allows high_pc to be an offset from low_pc
+				Dwarf_Addr hipc = (high.get_form() == encap::attribute_value::ADDR)
+					? high.get_address().addr : lopc + high.get_unsigned();
+				if (hipc > lopc) out.push_back(make_pair(lopc, hipc));
+			}
+		}
+
+		address_index::address_index(root_die& r)
+		{
+			vector<interval> intervals;
+			/* The ranged DIEs enclosing our position in the walk. */
+			vector<pair<unsigned short, node_id> > open;
+			vector<pair<Dwarf_Addr, Dwarf_Addr> > here;
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				if (!i.is_real_die_position()) continue;
+				unsigned short depth = i.depth();
+				while (!open.empty() && open.back().first >= depth) open.pop_back();
+				if (!tag_has_code_ranges(i.tag_here())) continue;
+				here.clear();
+				intervals_here(r, i, here);
+				/* Abstract instances (DW_AT_inline) have no ranges, and
+				 * neither do their blocks, so we skip them. */
+				if (here.empty()) continue;
+				node_id n = nodes.size();
+				node new_node = { i.offset_here(), i.tag_here(),
+					open.empty() ? NO_NODE : open.back().second };
+				nodes.push_back(new_node);
+				open.push_back(make_pair(depth, n));
+				for (auto i_ival = here.begin(); i_ival != here.end(); ++i_ival)
+				{
+					interval ival = { i_ival->first, i_ival->second, n, depth };
+					intervals.push_back(ival);
+				}
+			}
+			build_segments(intervals);
+		}
+
+		void address_index::add_segment(Dwarf_Addr lo, Dwarf_Addr hi, node_id n)
+		{
+			if (lo >= hi) return;
+			if (!seg_begins.empty() && seg_ends.back() == lo && seg_nodes.back() == n)
+			{
+				seg_ends.back() = hi;
+				return;
+			}
+			seg_begins.push_back(lo);
+			seg_ends.push_back(hi);
+			seg_nodes.push_back(n);
+		}
+
+		void address_index::build_segments(vector<interval>& intervals)
+		{
+			/* Outer before inner: by start address, then longest first, then
+			 * shallowest first (for a block exactly covering its function). */
+			std::sort(intervals.begin(), intervals.end(),
+				[](const interval& i1, const interval& i2) {
+					if (i1.lo != i2.lo) return i1.lo < i2.lo;
+					if (i1.hi != i2.hi) return i1.hi > i2.hi;
+					return i1.depth < i2.depth;
+				});
+			/* Sweep, keeping a stack of the intervals we're inside. Whatever
+			 * is on top of the stack is innermost for the stretch we emit. */
+			vector<interval> inside;
+			Dwarf_Addr cur = 0;
+			for (auto i_ival = intervals.begin(); i_ival != intervals.end(); ++i_ival)
+			{
+				interval ival = *i_ival;
+				while (!inside.empty() && inside.back().hi <= ival.lo)
+				{
+					add_segment(cur, inside.back().hi, inside.back().n);
+					cur = std::max(cur, inside.back().hi);
+					inside.pop_back();
+				}
+				if (!inside.empty())
+				{
+					add_segment(cur, ival.lo, inside.back().n);
+					/* A child overrunning its parent is bad DWARF; clip it. */
+					if (ival.hi > inside.back().hi) ival.hi = inside.back().hi;
+				}
+				cur = ival.lo;
+				inside.push_back(ival);
+			}
+			while (!inside.empty())
+			{
+				add_segment(cur, inside.back().hi, inside.back().n);
+				cur = std::max(cur, inside.back().hi);
+				inside.pop_back();
+			}
+		}
+
+		address_index::node_id address_index::innermost(Dwarf_Addr addr) const
+		{
+			auto found = std::upper_bound(seg_begins.begin(), seg_begins.end(), addr);
+			if (found == seg_begins.begin()) return NO_NODE;
+			unsigned k = (found - seg_begins.begin()) - 1;
+			return (addr < seg_ends[k]) ? seg_nodes[k] : NO_NODE;
+		}
+
+		address_index::node_id address_index::innermost(Dwarf_Addr addr, Dwarf_Addr *out_until) const
+		{
+			unsigned k = std::upper_bound(seg_begins.begin(), seg_begins.end(), addr) - seg_begins.begin();
+			if (k > 0 && addr < seg_ends[k - 1])
+			{
+				*out_until = seg_ends[k - 1];
+				return seg_nodes[k - 1];
+			}
+			/* In a gap, which lasts until the next segment. */
+			*out_until = (k < seg_begins.size()) ? seg_begins[k] : ~static_cast<Dwarf_Addr>(0);
+			return NO_NODE;
+		}
+
+		vector<address_index::node_id> address_index::chain(Dwarf_Addr addr) const
+		{
+			vector<node_id> out;
+			for (node_id n = innermost(addr); n != NO_NODE; n = nodes[n].parent) out.push_back(n);
+			return out;
+		}
+
+		address_index::node_id address_index::enclosing(Dwarf_Addr addr, Dwarf_Half tag) const
+		{
+			node_id n = innermost(addr);
+			while (n != NO_NODE && nodes[n].tag != tag) n = nodes[n].parent;
+			return n;
+		}
+
+		void cu_range_index::read_aranges(root_die& r, vector<range>& out)
+		{
+			if (!r.get_dbg().handle) return;
+			ArangeList aranges(ArangeList::try_construct(r.get_dbg().raw_handle()));
+			for (auto i_a = aranges.copied_list.begin(); i_a != aranges.copied_list.end(); ++i_a)
+			{
+				Dwarf_Addr start;
+				Dwarf_Unsigned length;
+				Dwarf_Off cu_die_off;
+				if (dwarf_get_arange_info(i_a->get(), &start, &length, &cu_die_off,
+					&current_dwarf_error) != DW_DLV_OK) continue;
+				if (length == 0) continue;
+				range rng = { start, start + length, cu_die_off };
+				out.push_back(rng);
+			}
+		}
+
+		cu_range_index::cu_range_index(root_die& r) : ncus_patched(0)
+		{
+			vector<range> aranges;
+			read_aranges(r, aranges);
+			std::sort(aranges.begin(), aranges.end(),
+				[](const range& r1, const range& r2) {
+					return r1.cu < r2.cu || (r1.cu == r2.cu && r1.lo < r2.lo);
+				});
+			vector<pair<Dwarf_Addr, Dwarf_Addr> > here;
+			auto cus = r.children();
+			for (auto i_cu = std::move(cus.first); i_cu != cus.second; ++i_cu)
+			{
+				Dwarf_Off cu_off = i_cu.offset_here();
+				/* Only aranges naming a CU we know are trusted. */
+				auto cu_aranges = std::equal_range(aranges.begin(), aranges.end(),
+					range { 0, 0, cu_off },
+					[](const range& r1, const range& r2) { return r1.cu < r2.cu; });
+				ranges.insert(ranges.end(), cu_aranges.first, cu_aranges.second);
+				here.clear();
+				address_index::intervals_here(r, i_cu, here);
+				bool patched = false;
+				for (auto i_ival = here.begin(); i_ival != here.end(); ++i_ival)
+				{
+					/* Is [lo, hi) covered by this CU's aranges, taken together? */
+					Dwarf_Addr reached = i_ival->first;
+					for (auto i_ar = cu_aranges.first;
+						i_ar != cu_aranges.second && i_ar->lo <= reached && reached < i_ival->second; ++i_ar)
+					{
+						reached = std::max(reached, i_ar->hi);
+					}
+					if (reached >= i_ival->second) continue;
+					range rng = { i_ival->first, i_ival->second, cu_off };
+					ranges.push_back(rng);
+					patched = true;
+				}
+				if (patched) ++ncus_patched;
+			}
+			std::sort(ranges.begin(), ranges.end(),
+				[](const range& r1, const range& r2) {
+					return r1.lo < r2.lo || (r1.lo == r2.lo && r1.hi > r2.hi);
+				});
+			/* Where a patch overlaps the aranges, or aranges abut, merge. */
+			vector<range> merged;
+			for (auto i_r = ranges.begin(); i_r != ranges.end(); ++i_r)
+			{
+				if (!merged.empty() && merged.back().cu == i_r->cu && i_r->lo <= merged.back().hi)
+				{
+					merged.back().hi = std::max(merged.back().hi, i_r->hi);
+				}
+				else merged.push_back(*i_r);
+			}
+			ranges = std::move(merged);
+			Dwarf_Addr running = 0;
+			for (auto i_r = ranges.begin(); i_r != ranges.end(); ++i_r)
+			{
+				running = std::max(running, i_r->hi);
+				max_hi.push_back(running);
+			}
+		}
+
+		opt<Dwarf_Off> cu_range_index::cu_for(Dwarf_Addr addr) const
+		{
+			unsigned k = std::upper_bound(ranges.begin(), ranges.end(), addr,
+				[](Dwarf_Addr a, const range& rng) { return a < rng.lo; }) - ranges.begin();
+			while (k > 0 && max_hi[k - 1] > addr)
+			{
+				--k;
+				if (ranges[k].hi > addr) return ranges[k].cu;
+			}
+			return opt<Dwarf_Off>();
+		}
+
+		static_data_index::static_data_index(root_die& r)
+		{
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				if (i.tag_here() != DW_TAG_variable || !i.has_attr_here(DW_AT_location)) continue;
+				auto i_var = i.as_a<variable_die>();
+				if (!i_var->has_static_storage()) continue;
+				/* This evaluates the location, and sizes the variable from
+				 * its type, once per variable, rather than once per query. */
+				auto intervals = i_var->file_relative_intervals(r, nullptr, nullptr);
+				for (auto i_int = intervals.begin(); i_int != intervals.end(); ++i_int)
+				{
+					entry e = { i_int->first.lower(), i_int->first.upper(), i.offset_here() };
+					entries.push_back(e);
+				}
+			}
+			std::sort(entries.begin(), entries.end(),
+				[](const entry& e1, const entry& e2) {
+					return e1.lo < e2.lo || (e1.lo == e2.lo && e1.hi < e2.hi);
+				});
+			Dwarf_Addr running = 0;
+			for (auto i_e = entries.begin(); i_e != entries.end(); ++i_e)
+			{
+				running = std::max(running, i_e->hi);
+				max_hi.push_back(running);
+			}
+		}
+
+		vector<const static_data_index::entry *>
+		static_data_index::find_all(Dwarf_Addr addr) const
+		{
+			vector<const entry *> out;
+			unsigned k = std::upper_bound(entries.begin(), entries.end(), addr,
+				[](Dwarf_Addr a, const entry& e) { return a < e.lo; }) - entries.begin();
+			/* Everything from k on starts after addr. Going backwards, once
+			 * nothing so far reaches past addr, nothing earlier can. */
+			while (k > 0 && max_hi[k - 1] > addr)
+			{
+				--k;
+				if (entries[k].hi > addr) out.push_back(&entries[k]);
+			}
+			return out;
+		}
+
+		const static_data_index::entry *
+		static_data_index::find(Dwarf_Addr addr) const
+		{
+			vector<const entry *> found = find_all(addr);
+			return found.empty() ? nullptr : found.front();
+		}
+
+		vector<iterator_base>
+		static_data_index::members_at(root_die& r, const entry& e,
+			Dwarf_Addr addr, Dwarf_Unsigned *out_residual)
+		{
+			vector<iterator_base> out;
+			assert(addr >= e.lo && addr < e.hi);
+			Dwarf_Unsigned off = addr - e.lo;
+			iterator_df<type_die> t = r.pos(e.var).as_a<variable_die>()->find_type();
+			while (t && (t = t->get_concrete_type()))
+			{
+				if (t.is_a<with_data_members_die>())
+				{
+					auto members = t.as_a<with_data_members_die>().children().subseq_of<data_member_die>();
+					bool found = false;
+					for (auto i_memb = members.first; i_memb != members.second; ++i_memb)
+					{
+						opt<Dwarf_Unsigned> memb_off = i_memb->byte_offset_in_enclosing_type();
+						/* Don't use find_or_create_type_handling_bitfields():
+						 * it may make_new a base type, which drops every index,
+						 * including the one our caller's entry points into. */
+						iterator_df<type_die> memb_t = i_memb->find_type();
+						opt<Dwarf_Unsigned> memb_size = memb_t ? memb_t->calculate_byte_size()
+							: opt<Dwarf_Unsigned>();
+						auto i_bitfield = i_memb.as_a<member_die>();
+						if (i_bitfield && i_bitfield->get_bit_size())
+						{
+							/* A bitfield covers the bytes holding its bits, if we
+							 * know exactly where those are; otherwise, its whole
+							 * storage unit. Either way there is nothing inside it. */
+							opt<Dwarf_Unsigned> data_boff = i_bitfield->get_data_bit_offset();
+							if (data_boff)
+							{
+								memb_off = *data_boff / 8;
+								memb_size = (*data_boff % 8 + *i_bitfield->get_bit_size() + 7) / 8;
+							}
+							memb_t = iterator_base::END;
+						}
+						if (!memb_off || !memb_size
+							|| off < *memb_off || off >= *memb_off + *memb_size) continue;
+						out.push_back(i_memb);
+						off -= *memb_off;
+						t = memb_t;
+						found = true;
+						break;
+					}
+					if (!found) break;
+				}
+				else if (t.is_a<array_type_die>())
+				{
+					iterator_df<type_die> elem_t = t.as_a<array_type_die>()->find_type();
+					opt<Dwarf_Unsigned> elem_size = elem_t ? elem_t->calculate_byte_size()
+						: opt<Dwarf_Unsigned>();
+					if (!elem_size || *elem_size == 0) break;
+					off %= *elem_size;
+					t = elem_t;
+				}
+				else break;
+			}
+			if (out_residual) *out_residual = off;
+			return out;
+		}
+	}
+}
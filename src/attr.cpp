@@ -204,7 +204,7 @@ namespace dwarf
 				case spec::interp::loclistptr: switch(f)
 				{
 					case LOCLIST:
-						s << *v_loclist; 
+						s << get_loclist(); 
 						break;
 					default: assert(false);
 				} break;
@@ -250,6 +250,18 @@ namespace dwarf
 			}
 		} // end attribute_value::print_as
 		
+		const loclist& attribute_value::get_loclist() const
+		{
+			assert(is_loclist());
+			return loclist_is_pooled ? loclist_pool::get(v_pooled_loclist) : *v_loclist;
+		}
+		
+		void attribute_value::set_pooled_loclist(root_die& r, const loclist& l)
+		{
+			this->v_pooled_loclist = r.get_loclist_pool().intern(l);
+			this->loclist_is_pooled = true;
+		}
+		
 		// temporary HACK: copy  (... increasingly less like a copy)
 		attribute_value::attribute_value(const dwarf::core::Attribute& a, 
 			const core::Die& d,
@@ -267,16 +279,17 @@ namespace dwarf
 			char *str;
 			int cls = spec::interp::EOL; // dummy initialization
 			
-			// find our dwarf spec
-			Dwarf_Off cu_offset = d.enclosing_cu_offset_here();
-			dwarf::spec::abstract_def& spec = r.cu_pos(cu_offset).spec_here();
+			/* Find our dwarf spec. Asking the handle is enough: going via
+			 * r.cu_pos() would build an iterator (and maybe a CU payload)
+			 * just to get the same answer, for every attribute we decode. */
+			dwarf::spec::abstract_def& spec = d.spec_here();
 
 			if (retval != DW_DLV_OK) goto fail; // retval set by whatform() above
 			Dwarf_Half attr; 
 			retval = dwarf_whatattr(a.handle.get(), &attr, &core::current_dwarf_error);
 			if (retval != DW_DLV_OK) goto fail;
 			
-			cls = spec.get_interp(attr, orig_form);
+			cls = spec.interp_for(attr, orig_form);
 			switch(cls & ~spec::interp::FLAGS)
 			{
 				case spec::interp::string:
@@ -369,7 +382,7 @@ namespace dwarf
 					int ret = dwarf_formudata(a.handle.get(), &u, &core::current_dwarf_error);
 					assert(ret == DW_DLV_OK);
 					this->f = LOCLIST;
-					this->v_loclist = new loclist(loc_expr((Dwarf_Unsigned[]) { DW_OP_plus_uconst, u }, 0, 0, spec));
+					set_pooled_loclist(r, loclist(loc_expr((Dwarf_Unsigned[]) { DW_OP_plus_uconst, u }, 0, 0, spec)));
 				} break;
 				case spec::interp::block_as_dwarf_expr: // dwarf_loclist_n works for both of these
 				case spec::interp::loclistptr:
@@ -379,8 +392,8 @@ namespace dwarf
 						// replaced lib::loclist with core::LocdescList
 						//this->v_loclist = new loclist(dwarf::lib::loclist(a, a.get_dbg()));
 						auto handle = core::LocdescList::try_construct(a);
-						if (handle) this->v_loclist = new loclist(core::LocdescList(std::move(handle)));
-						else this->v_loclist = new loclist();
+						if (handle) set_pooled_loclist(r, loclist(core::LocdescList(std::move(handle))));
+						else set_pooled_loclist(r, loclist());
 						break;
 					}
 					catch (...)
@@ -394,8 +407,8 @@ namespace dwarf
 					{
 						this->f = LOCLIST;
 						auto handle = core::Locdesc::try_construct(a);
-						if (handle) this->v_loclist = new loclist(core::Locdesc(std::move(handle)));
-						else this->v_loclist = new loclist();
+						if (handle) set_pooled_loclist(r, loclist(core::Locdesc(std::move(handle))));
+						else set_pooled_loclist(r, loclist());
 						break;
 					}
 					catch (...)
@@ -483,6 +496,7 @@ namespace dwarf
 		attribute_map::attribute_map(const core::AttributeList& l, const core::Die& d, 
 			root_die& r, spec::abstract_def& spec /* = 0 */)
 		{
+			reserve(l.copied_list.size());
 			for (auto i = l.copied_list.begin(); i != l.copied_list.end(); ++i)
 			{
 				this->insert(make_pair(i->attr_here(), attribute_value(*i, d, r)));
@@ -537,7 +551,14 @@ namespace dwarf
 					v_addr = av.v_addr;
 				break;
 				case LOCLIST:
-					v_loclist = new loclist(*av.v_loclist);
+					// pooled loclists are immutable, so share them
+					loclist_is_pooled = av.loclist_is_pooled;
+					if (loclist_is_pooled)
+					{
+						loclist_pool::acquire(av.v_pooled_loclist);
+						v_pooled_loclist = av.v_pooled_loclist;
+					}
+					else v_loclist = new loclist(*av.v_loclist);
 				break;
 				case RANGELIST:
 					v_rangelist = new rangelist(*av.v_rangelist);
@@ -574,7 +595,10 @@ namespace dwarf
 				case ADDR:
 					return this->v_addr == v.v_addr;
 				case LOCLIST:
-					return *(this->v_loclist) == *(v.v_loclist);
+					// pooled entries are equal iff identical, if from the same pool
+					return (loclist_is_pooled && v.loclist_is_pooled
+							&& this->v_pooled_loclist == v.v_pooled_loclist)
+						|| this->get_loclist() == v.get_loclist();
 				case RANGELIST:
 					return *(this->v_rangelist) == *(v.v_rangelist);
 				default: 
@@ -602,7 +626,8 @@ namespace dwarf
 					delete v_ref;
 				break;
 				case LOCLIST:
-					delete v_loclist;
+					if (loclist_is_pooled) loclist_pool::release(v_pooled_loclist);
+					else delete v_loclist;
 				break;
 				case RANGELIST:
 					delete v_rangelist;
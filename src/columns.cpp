@@ -0,0 +1,280 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * columns.cpp: bulk, columnar projection of attributes over many DIEs.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/expr.hpp"
+#include "dwarfpp/columns.hpp"
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		unsigned attr_columns::intern(const char *s)
+		{
+			auto found = string_atoms.find(s);
+			if (found != string_atoms.end()) return found->second;
+			unsigned atom = strings.size();
+			strings.push_back(s);
+			string_atoms.insert(make_pair(strings.back(), atom));
+			return atom;
+		}
+
+		attr_projector::layout
+		attr_projector::make_layout(Dwarf_Attribute *attrs, Dwarf_Signed len, spec& s) const
+		{
+			layout l;
+			l.any = false;
+			for (auto i_col = out.columns.begin(); i_col != out.columns.end(); ++i_col)
+			{
+				slot sl = { -1, 0, dwarf::spec::interp::EOL, false, false };
+				for (Dwarf_Signed i = 0; i < len; ++i)
+				{
+					Dwarf_Half attr;
+					int ret = dwarf_whatattr(attrs[i], &attr, &current_dwarf_error);
+					if (ret != DW_DLV_OK || attr != i_col->attr) continue;
+					sl.index = i;
+					/* Ask for the form as written in the abbreviation. If it's
+					 * indirect, the real form is in the DIE, so can differ
+					 * between DIEs sharing this layout. */
+					ret = dwarf_whatform_direct(attrs[i], &sl.form, &current_dwarf_error);
+					sl.failed = (ret != DW_DLV_OK);
+					sl.indirect = !sl.failed && (sl.form == DW_FORM_indirect);
+					if (!sl.failed && !sl.indirect) sl.cls = s.interp_for(attr, sl.form);
+					l.any = true;
+					break;
+				}
+				l.slots.push_back(sl);
+			}
+			return l;
+		}
+
+		void attr_projector::decode(Dwarf_Attribute a, const slot& sl, Dwarf_Die d,
+			spec& s, attr_columns::column& c, unsigned row)
+		{
+			unsigned char& kind = c.kinds[row];
+			Dwarf_Unsigned& value = c.values[row];
+			Dwarf_Half form = sl.form;
+			int cls = sl.cls;
+			if (sl.failed) goto failed;
+			if (sl.indirect)
+			{
+				if (dwarf_whatform(a, &form, &current_dwarf_error) != DW_DLV_OK) goto failed;
+				cls = s.interp_for(c.attr, form);
+			}
+			/* This mirrors the decoding in attribute_value's constructor,
+			 * minus the cases that don't flatten to an integer. */
+			switch (cls & ~dwarf::spec::interp::FLAGS)
+			{
+				case dwarf::spec::interp::string: {
+					char *str;
+					if (dwarf_formstring(a, &str, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::ATOM;
+					value = out.intern(str);
+				} break;
+				case dwarf::spec::interp::flag: {
+					Dwarf_Bool flag;
+					if (dwarf_formflag(a, &flag, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::FLAG;
+					value = flag;
+				} break;
+				case dwarf::spec::interp::address: {
+					Dwarf_Addr addr;
+					if (dwarf_formaddr(a, &addr, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::ADDRESS;
+					value = addr;
+				} break;
+				case dwarf::spec::interp::reference: {
+					Dwarf_Off o;
+					if (dwarf_global_formref(a, &o, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::REFERENCE;
+					value = o;
+				} break;
+				case dwarf::spec::interp::constant:
+					if (form == DW_FORM_sdata) goto as_signed;
+					if (form == DW_FORM_sec_offset) goto as_section_offset;
+					// else fall through
+				case dwarf::spec::interp::constant_to_make_location_expr: {
+					/* Note: a constant data_member_location comes out as
+					 * the plain offset, not the DW_OP_plus_uconst that
+					 * attribute_value would make of it. */
+					Dwarf_Unsigned u;
+					if (dwarf_formudata(a, &u, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::UNSIGNED;
+					value = u;
+				} break;
+				as_signed: {
+					Dwarf_Signed sv;
+					if (dwarf_formsdata(a, &sv, &current_dwarf_error) != DW_DLV_OK) goto failed;
+					kind = attr_columns::SIGNED;
+					value = static_cast<Dwarf_Unsigned>(sv);
+				} break;
+				case dwarf::spec::interp::lineptr:
+				case dwarf::spec::interp::macptr:
+				case dwarf::spec::interp::loclistptr:
+				case dwarf::spec::interp::rangelistptr:
+				as_section_offset: {
+					Dwarf_Off o;
+					Dwarf_Unsigned u;
+					if (form == DW_FORM_sec_offset)
+					{
+						if (dwarf_global_formref(a, &o, &current_dwarf_error) != DW_DLV_OK) goto failed;
+						value = o;
+					}
+					else if (form == DW_FORM_data4 || form == DW_FORM_data8)
+					{
+						// DWARF 2 and 3 used plain data forms for these
+						if (dwarf_formudata(a, &u, &current_dwarf_error) != DW_DLV_OK) goto failed;
+						value = u;
+					}
+					else goto opaque; // e.g. a DWARF 2 location block
+					kind = attr_columns::SECTION_OFFSET;
+				} break;
+				case dwarf::spec::interp::exprloc: {
+					/* The one location we flatten is the static one, i.e.
+					 * a lone DW_OP_addr. We check the opcode byte ourselves
+					 * so that we only get libdwarf to decode (and allocate)
+					 * when the answer is going to be useful. */
+					Dwarf_Unsigned len;
+					Dwarf_Ptr bytes;
+					Dwarf_Half addr_size;
+					if (dwarf_formexprloc(a, &len, &bytes, &current_dwarf_error) != DW_DLV_OK
+						|| dwarf_get_die_address_size(d, &addr_size, &current_dwarf_error) != DW_DLV_OK)
+					{ goto failed; }
+					if (len == 0
+						|| *static_cast<unsigned char *>(bytes) != DW_OP_addr
+						|| len != 1u + addr_size) goto opaque;
+					auto h = Locdesc::try_construct(r.get_dbg().raw_handle(), bytes, len);
+					if (!h) goto failed;
+					if (h->ld_cents != 1) goto opaque;
+					kind = attr_columns::ADDRESS;
+					value = h->ld_s[0].lr_number;
+				} break;
+				opaque:
+				default:
+					kind = attr_columns::OPAQUE;
+					value = 0;
+					break;
+			}
+			return;
+		failed:
+			kind = attr_columns::FAILED;
+			value = 0;
+		}
+
+		/* For DIEs without a libdwarf handle, i.e. in-memory ones, we do
+		 * it the slow way. There shouldn't be many. */
+		void attr_projector::add_generic(const iterator_base& i, unsigned row)
+		{
+			encap::attribute_map m = i.copy_attrs();
+			for (auto i_col = out.columns.begin(); i_col != out.columns.end(); ++i_col)
+			{
+				auto found = m.find(i_col->attr);
+				if (found == m.end()) continue;
+				const encap::attribute_value& v = found->second;
+				unsigned char& kind = i_col->kinds[row];
+				Dwarf_Unsigned& value = i_col->values[row];
+				switch (v.get_form())
+				{
+					case encap::attribute_value::STRING:
+						kind = attr_columns::ATOM; value = out.intern(v.get_string().c_str()); break;
+					case encap::attribute_value::FLAG:
+						kind = attr_columns::FLAG; value = v.get_flag(); break;
+					case encap::attribute_value::UNSIGNED:
+						kind = attr_columns::UNSIGNED; value = v.get_unsigned(); break;
+					case encap::attribute_value::SIGNED:
+						kind = attr_columns::SIGNED; value = v.get_signed(); break;
+					case encap::attribute_value::ADDR:
+						kind = attr_columns::ADDRESS; value = v.get_address().addr; break;
+					case encap::attribute_value::REF:
+						kind = attr_columns::REFERENCE; value = v.get_refoff(); break;
+					case encap::attribute_value::LOCLIST: {
+						const encap::loclist& ll = v.get_loclist();
+						if (ll.size() == 1 && ll[0].size() == 1 && ll[0][0].lr_atom == DW_OP_addr)
+						{
+							kind = attr_columns::ADDRESS; value = ll[0][0].lr_number;
+						}
+						else kind = attr_columns::OPAQUE;
+					} break;
+					default:
+						kind = attr_columns::OPAQUE; break;
+				}
+			}
+		}
+
+		void attr_projector::add(const iterator_base& i)
+		{
+			assert(i.is_real_die_position());
+			unsigned row = out.size();
+			out.offsets.push_back(i.offset_here());
+			out.tags.push_back(i.tag_here());
+			for (auto i_col = out.columns.begin(); i_col != out.columns.end(); ++i_col)
+			{
+				i_col->kinds.push_back(attr_columns::ABSENT);
+				i_col->values.push_back(0);
+			}
+
+			Die *p_d = dynamic_cast<Die *>(&i.get_handle());
+			if (!p_d || !p_d->handle) { add_generic(i, row); return; }
+			Dwarf_Die raw = p_d->raw_handle();
+			spec& s = p_d->spec_here();
+
+			auto key = make_pair(p_d->enclosing_cu_offset_here(),
+				(Dwarf_Unsigned) dwarf_die_abbrev_code(raw));
+			auto found = layouts.find(key);
+			if (found != layouts.end() && !found->second.any) return; // nothing for us here
+
+			/* We use the raw attribute block rather than an AttributeList,
+			 * to avoid allocating a vector of handles per DIE. */
+			auto h = AttributeList::try_construct(*p_d);
+			if (!h) throw Error(current_dwarf_error, 0);
+			Dwarf_Signed len = h.get_deleter().len;
+			Dwarf_Attribute *attrs = (len > 0) ? h.get() : nullptr;
+			struct attrs_deleter
+			{
+				Dwarf_Debug dbg; Dwarf_Attribute *attrs; Dwarf_Signed len;
+				~attrs_deleter()
+				{ for (Dwarf_Signed i = 0; i < len; ++i) dwarf_dealloc(dbg, attrs[i], DW_DLA_ATTR); }
+			} del = { p_d->get_dbg(), attrs, len };
+
+			if (found == layouts.end())
+			{
+				found = layouts.insert(make_pair(key, make_layout(attrs, len, s))).first;
+			}
+			const layout& l = found->second;
+			for (unsigned n = 0; n < l.slots.size(); ++n)
+			{
+				const slot& sl = l.slots[n];
+				if (sl.index == -1) continue;
+				if (sl.index >= len)
+				{
+					// can't happen if libdwarf is consistent about the abbreviation
+					out.columns[n].kinds[row] = attr_columns::FAILED;
+					continue;
+				}
+				decode(attrs[sl.index], sl, raw, s, out.columns[n], row);
+			}
+		}
+
+		attr_columns
+		project_attrs(root_die& r, Dwarf_Half tag, const vector<Dwarf_Half>& attrs)
+		{
+			attr_columns out(attrs);
+			attr_projector p(r, out);
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				if (i.is_real_die_position() && i.tag_here() == tag) p.add(i);
+			}
+			return out;
+		}
+	}
+}
@@ -0,0 +1,193 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * demangled-names.cpp: subprograms and variables by demangled name.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include <cxxabi.h>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/demangled-names.hpp"
+#include "dwarfpp/util.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		static string demangle_uncached(const string& mangled)
+		{
+			int status = -1;
+			char *out = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+			string ret = (status == 0 && out) ? string(out) : string();
+			std::free(out);
+			return ret;
+		}
+
+		demangled_name_index::demangled_name_index(root_die& r)
+		{
+			/* Gather first, so that we demangle each distinct name once
+			 * however many DIEs (declarations, out-of-line copies) share it. */
+			vector<pair<string, Dwarf_Off> > mangled_dies;
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				Dwarf_Half tag = i.tag_here();
+				if (tag != DW_TAG_subprogram && tag != DW_TAG_variable) continue;
+				if (i.has_attr_here(DW_AT_linkage_name))
+				{
+					mangled_dies.push_back(make_pair(
+						i.attr(DW_AT_linkage_name).get_string(), i.offset_here()));
+				}
+				else if (i.has_attr_here(DW_AT_MIPS_linkage_name))
+				{
+					mangled_dies.push_back(make_pair(
+						i.attr(DW_AT_MIPS_linkage_name).get_string(), i.offset_here()));
+				}
+				else if (i.has_attr_here(DW_AT_external) && i.attr(DW_AT_external).get_flag())
+				{
+					name_ref name = i.name_ref_here();
+					if (name.empty()) continue;
+					string key = normalize(name.to_string());
+					by_signature.insert(make_pair(key, i.offset_here()));
+					by_qualified_name.insert(make_pair(key, i.offset_here()));
+				}
+			}
+			/* Demangling is pure computation, so the distinct names can be
+			 * shared out among threads, without needing the root. Each fills
+			 * in its own entries; nothing is inserted meanwhile. */
+			struct keys { string signature; string qualified; };
+			std::unordered_map<string, keys> keys_for;
+			vector<std::unordered_map<string, string>::iterator> distinct;
+			for (auto i_m = mangled_dies.begin(); i_m != mangled_dies.end(); ++i_m)
+			{
+				auto inserted = demangled.insert(make_pair(i_m->first, string()));
+				if (inserted.second) distinct.push_back(inserted.first);
+			}
+			vector<keys> distinct_keys(distinct.size());
+			parallel_for(distinct.size(), r.index_thread_limit(),
+				[&distinct, &distinct_keys](unsigned n, unsigned) {
+					const string& mangled = distinct[n]->first;
+					string& out = distinct[n]->second;
+					out = demangle_uncached(mangled);
+					/* If it doesn't demangle, e.g. an extern "C" variable
+					 * with a linkage name, the linkage name is the name. */
+					distinct_keys[n].signature = normalize(out.empty() ? mangled : out);
+					distinct_keys[n].qualified = strip_signature(distinct_keys[n].signature);
+				});
+			keys_for.reserve(distinct.size());
+			for (unsigned n = 0; n < distinct.size(); ++n)
+			{
+				keys_for.insert(make_pair(distinct[n]->first, std::move(distinct_keys[n])));
+			}
+			for (auto i_m = mangled_dies.begin(); i_m != mangled_dies.end(); ++i_m)
+			{
+				const keys& k = keys_for.find(i_m->first)->second;
+				by_signature.insert(make_pair(k.signature, i_m->second));
+				by_qualified_name.insert(make_pair(k.qualified, i_m->second));
+			}
+		}
+
+		static bool is_ident_char(char c)
+		{ return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+		string demangled_name_index::normalize(const string& s)
+		{
+			string out;
+			out.reserve(s.size());
+			for (string::size_type pos = 0; pos < s.size(); )
+			{
+				if (!std::isspace(static_cast<unsigned char>(s[pos]))) { out += s[pos++]; continue; }
+				string::size_type end = pos;
+				while (end < s.size() && std::isspace(static_cast<unsigned char>(s[end]))) ++end;
+				if (!out.empty() && end < s.size() && is_ident_char(out.back()) && is_ident_char(s[end]))
+				{
+					out += ' ';
+				}
+				pos = end;
+			}
+			return out;
+		}
+
+		string demangled_name_index::strip_signature(const string& normalized)
+		{
+			/* The parameters are a parenthesised group ending the name, give
+			 * or take cv- and ref-qualifiers. Anything else, like the local
+			 * static foo()::x, is not a function's signature. */
+			string::size_type end = normalized.size();
+			for (bool stripped = true; stripped; )
+			{
+				stripped = false;
+				while (end > 0 && (normalized[end - 1] == '&' || normalized[end - 1] == ' '))
+				{ --end; stripped = true; }
+				for (const char *qual : { "const", "volatile" })
+				{
+					string::size_type len = std::strlen(qual);
+					if (end >= len && normalized.compare(end - len, len, qual) == 0
+						&& (end == len || !is_ident_char(normalized[end - len - 1])))
+					{ end -= len; stripped = true; }
+				}
+			}
+			if (end == 0 || normalized[end - 1] != ')') return normalized;
+			string::size_type close = end - 1;
+			int nesting = 0;
+			string::size_type open = string::npos;
+			for (string::size_type pos = close + 1; pos-- > 0; )
+			{
+				if (normalized[pos] == ')') ++nesting;
+				else if (normalized[pos] == '(' && --nesting == 0) { open = pos; break; }
+			}
+			if (open == string::npos || open == 0) return normalized;
+			string name = normalized.substr(0, open);
+			/* A return type ends at the last top-level space, unless the
+			 * space is part of an operator's name. */
+			if (name.find("operator") != string::npos) return name;
+			nesting = 0;
+			for (string::size_type pos = name.size(); pos-- > 0; )
+			{
+				char c = name[pos];
+				if (c == '>' || c == ')') ++nesting;
+				else if ((c == '<' || c == '(') && nesting > 0) --nesting;
+				else if (c == ' ' && nesting == 0) return name.substr(pos + 1);
+			}
+			return name;
+		}
+
+		vector<Dwarf_Off> demangled_name_index::collect(
+			const std::unordered_multimap<string, Dwarf_Off>& m, const string& key)
+		{
+			vector<Dwarf_Off> out;
+			auto found = m.equal_range(key);
+			for (auto i_f = found.first; i_f != found.second; ++i_f) out.push_back(i_f->second);
+			std::sort(out.begin(), out.end());
+			return out;
+		}
+
+		vector<Dwarf_Off> demangled_name_index::find_signature(const string& signature) const
+		{
+			return collect(by_signature, normalize(signature));
+		}
+
+		vector<Dwarf_Off> demangled_name_index::find_qualified(const string& qualified) const
+		{
+			return collect(by_qualified_name, normalize(qualified));
+		}
+
+		opt<string> demangled_name_index::demangle(const string& mangled) const
+		{
+			auto found = demangled.find(mangled);
+			string out = (found != demangled.end()) ? found->second : demangle_uncached(mangled);
+			return out.empty() ? opt<string>() : opt<string>(out);
+		}
+	}
+}
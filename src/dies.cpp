@@ -14,6 +14,7 @@
 #include "dwarfpp/iter-inl.hpp"
 #include "dwarfpp/dies.hpp"
 #include "dwarfpp/dies-inl.hpp"
+#include "dwarfpp/line-table.hpp"
 
 #include <memory>
 #include <boost/filesystem.hpp>
@@ -32,19 +33,168 @@ namespace dwarf
 	{
 		using std::make_unique;
 		
-		opt<std::string> compile_unit_die::source_file_fq_pathname(unsigned o) const
+		/* Common to the direct_attr_ functions: get the attribute and its
+		 * interpretation. Returns false if there's nothing to decode, in
+		 * which case either it's absent or fallback is set. */
+		static bool direct_attr_prologue(const Die& d, Dwarf_Half attr, bool& fallback,
+			Attribute::handle_type& h, Dwarf_Half& form, int& cls)
 		{
-			string filepath;
-			try
+			if (!d.handle) { fallback = true; return false; }
+			Dwarf_Attribute raw;
+			int ret = dwarf_attr(d.raw_handle(), attr, &raw, &current_dwarf_error);
+			if (ret == DW_DLV_NO_ENTRY) return false;
+			if (ret != DW_DLV_OK) { fallback = true; return false; }
+			h = Attribute::handle_type(raw, Attribute::deleter(d.get_dbg()));
+			ret = dwarf_whatform(raw, &form, &current_dwarf_error);
+			if (ret != DW_DLV_OK) { fallback = true; return false; }
+			cls = d.spec_here().interp_for(attr, form);
+			return true;
+		}
+		/* Constants as attribute_value would read them. Returns false if
+		 * the form isn't one we do here. */
+		static bool direct_constant(Dwarf_Attribute a, Dwarf_Half form, int cls,
+			Dwarf_Unsigned& u, Dwarf_Signed& s, bool& is_signed)
+		{
+			if ((cls & ~dwarf::spec::interp::FLAGS) != dwarf::spec::interp::constant) return false;
+			switch (form)
 			{
-				filepath = source_file_name(o);
-			} catch (dwarf::lib::Error e)
+				case DW_FORM_sdata:
+					is_signed = true; break;
+				case DW_FORM_udata:
+					is_signed = false; break;
+				case DW_FORM_data1:
+				case DW_FORM_data2:
+				case DW_FORM_data4:
+				case DW_FORM_data8:
+					is_signed = (cls & dwarf::spec::interp::SIGNED); break;
+				default: return false;
+			}
+			if (is_signed) return dwarf_formsdata(a, &s, &current_dwarf_error) == DW_DLV_OK;
+			else return dwarf_formudata(a, &u, &current_dwarf_error) == DW_DLV_OK;
+		}
+		
+		opt<stored_type_string> direct_attr_string(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			/* Names are the commonest, and libdwarf has a call for them. */
+			if (attr == DW_AT_name && d.handle)
 			{
-				debug() << "Warning: source_file_name threw libdwarf error: "
-					<< dwarf_errmsg(current_dwarf_error) << std::endl;
-				return opt<string>();
+				name_ref n = d.name_ref_here();
+				if (n.empty()) return opt<stored_type_string>();
+				return string(n.begin(), n.end());
 			}
-			opt<string> maybe_dir = this->get_comp_dir();
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_string>();
+			char *str;
+			if ((cls & ~dwarf::spec::interp::FLAGS) != dwarf::spec::interp::string
+				|| dwarf_formstring(h.get(), &str, &current_dwarf_error) != DW_DLV_OK)
+			{ fallback = true; return opt<stored_type_string>(); }
+			return string(str);
+		}
+		opt<stored_type_flag> direct_attr_flag(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_flag>();
+			Dwarf_Bool flag;
+			if ((cls & ~dwarf::spec::interp::FLAGS) != dwarf::spec::interp::flag
+				|| dwarf_formflag(h.get(), &flag, &current_dwarf_error) != DW_DLV_OK)
+			{ fallback = true; return opt<stored_type_flag>(); }
+			return (stored_type_flag) flag;
+		}
+		opt<stored_type_unsigned> direct_attr_unsigned(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_unsigned>();
+			Dwarf_Unsigned u;
+			Dwarf_Signed s;
+			bool is_signed;
+			if (!direct_constant(h.get(), form, cls, u, s, is_signed))
+			{ fallback = true; return opt<stored_type_unsigned>(); }
+			// like attribute_value::get_unsigned(), we tolerate signed values
+			return is_signed ? static_cast<Dwarf_Unsigned>(s) : u;
+		}
+		opt<stored_type_signed> direct_attr_signed(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_signed>();
+			Dwarf_Unsigned u;
+			Dwarf_Signed s;
+			bool is_signed;
+			if (!direct_constant(h.get(), form, cls, u, s, is_signed))
+			{ fallback = true; return opt<stored_type_signed>(); }
+			return is_signed ? s : static_cast<Dwarf_Signed>(u);
+		}
+		opt<stored_type_address> direct_attr_address(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_address>();
+			Dwarf_Addr addr;
+			if ((cls & ~dwarf::spec::interp::FLAGS) != dwarf::spec::interp::address
+				|| dwarf_formaddr(h.get(), &addr, &current_dwarf_error) != DW_DLV_OK)
+			{ fallback = true; return opt<stored_type_address>(); }
+			return stored_type_address(addr);
+		}
+		opt<stored_type_refiter> direct_attr_refiter(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_refiter>();
+			Dwarf_Off o;
+			if ((cls & ~dwarf::spec::interp::FLAGS) != dwarf::spec::interp::reference
+				|| dwarf_global_formref(h.get(), &o, &current_dwarf_error) != DW_DLV_OK)
+			{ fallback = true; return opt<stored_type_refiter>(); }
+			return d.get_constructing_root().pos(o);
+		}
+		opt<stored_type_refiter_is_type> direct_attr_refiter_is_type(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			return direct_attr_refiter(d, attr, fallback);
+		}
+		opt<stored_type_loclist> direct_attr_loclist(const Die& d, Dwarf_Half attr, bool& fallback)
+		{
+			Attribute::handle_type h(nullptr, Attribute::deleter(nullptr));
+			Dwarf_Half form;
+			int cls;
+			if (!direct_attr_prologue(d, attr, fallback, h, form, cls)) return opt<stored_type_loclist>();
+			switch (cls & ~dwarf::spec::interp::FLAGS)
+			{
+				case dwarf::spec::interp::constant_to_make_location_expr: {
+					/* e.g. a data_member_location that is just an offset */
+					Dwarf_Unsigned u;
+					if (dwarf_formudata(h.get(), &u, &current_dwarf_error) != DW_DLV_OK) break;
+					Dwarf_Unsigned ops[] = { DW_OP_plus_uconst, u };
+					return encap::loclist(encap::loc_expr(ops, 0, 0, d.spec_here()));
+				}
+				case dwarf::spec::interp::exprloc: try {
+					Attribute a(std::move(h));
+					auto handle = Locdesc::try_construct(a);
+					if (handle) return encap::loclist(Locdesc(std::move(handle)));
+					else return encap::loclist();
+				} catch (...) { break; } // let the generic path complain
+				default: break;
+			}
+			fallback = true;
+			return opt<stored_type_loclist>();
+		}
+		
+		const line_table& compile_unit_die::get_line_table() const
+		{
+			/* CU payloads are sticky, so this is decoded once per CU. */
+			if (!p_line_table) p_line_table = std::make_shared<line_table>(d);
+			return *p_line_table;
+		}
+
+		static opt<string> fq_pathname(const opt<string>& maybe_dir, const string& filepath)
+		{
 			if (filepath.length() > 0 && filepath.at(0) == '/') return opt<string>(filepath);
 			else if (!maybe_dir) return opt<string>();
 			else
@@ -66,14 +216,42 @@ namespace dwarf
 			}
 		}
 
+		void compile_unit_die::load_source_files() const
+		{
+			StringList names(d); // throws if libdwarf can't read the table
+			std::vector<string> loaded;
+			loaded.reserve(names.get_len());
+			for (Dwarf_Signed i = 0; i < names.get_len(); ++i) loaded.push_back(names[i]);
+			opt<string> maybe_dir = this->get_comp_dir();
+			source_files_fq.clear();
+			for (auto i_f = loaded.begin(); i_f != loaded.end(); ++i_f)
+			{
+				source_files_fq.push_back(fq_pathname(maybe_dir, *i_f));
+			}
+			source_files = std::move(loaded);
+		}
+
+		opt<std::string> compile_unit_die::source_file_fq_pathname(unsigned o) const
+		{
+			try
+			{
+				if (!source_files) load_source_files();
+			} catch (dwarf::lib::Error e)
+			{
+				debug() << "Warning: source_file_name threw libdwarf error: "
+					<< dwarf_errmsg(current_dwarf_error) << std::endl;
+				return opt<string>();
+			}
+			assert(o <= source_files_fq.size());
+			return source_files_fq.at(o - 1);
+		}
+
 		iterator_base
 		with_named_children_die::named_child(const std::string& name) const
 		{
-			/* The default implementation just asks the root. Since we've somehow 
-			 * been called via the payload, we have the added inefficiency of 
-			 * searching for ourselves first. This shouldn't happen, though 
-			 * I'm not sure if we explicitly avoid it. Warn. */
-			debug(2) << "Warning: inefficient usage of with_named_children_die::named_child" << endl;
+			/* The default implementation just asks the root, whose per-scope
+			 * index makes this cheap after the first lookup. We don't need to
+			 * search for ourselves first; an iterator can be made from us. */
 
 			/* NOTE: the idea about payloads knowing about their children is 
 			 * already dodgy because it breaks our "no knowledge of structure" 
@@ -94,10 +272,7 @@ namespace dwarf
 			 * linear search in the common case, but fall back to it in weird
 			 * scenarios (deletions). 
 			 */
-			root_die& r = get_root();
-			Dwarf_Off off = get_offset();
-			auto start_iter = r.find(off);
-			return r.find_named_child(start_iter, name); 
+			return get_root().find_named_child(find_self(), name);
 		}
 		
 		/* type abstract equality and abstract naming. */
@@ -3710,7 +3885,8 @@ namespace dwarf
 			sym_resolver_t sym_resolve /* = sym_resolver_t() */,
 			void *arg /* = 0 */) const
 		{
-			// FIXME: cache intervals
+			/* We don't cache intervals. For code, the root's address_index
+			 * has them for every DIE at once. */
 			auto intervals = file_relative_intervals(r, sym_resolve, arg);
 			auto found = intervals.find(file_relative_address);
 			if (found != intervals.end())
@@ -10,6 +10,7 @@
 #include <map>
 #include <set>
 #include <srk31/endian.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "abstract.hpp"
 #include "abstract-inl.hpp"
@@ -20,6 +21,7 @@
 #include "dwarfpp/iter-inl.hpp"
 #include "dwarfpp/dies.hpp"
 #include "dwarfpp/dies-inl.hpp"
+#include "dwarfpp/packed-expr.hpp"
 
 using std::map;
 using std::pair;
@@ -443,6 +445,73 @@ namespace dwarf
 				push_back(rl.handle.get()[i]);
 			}
 		}
+		struct pooled_loclist
+		{
+			packed_loclist packed;
+			const spec::abstract_def& spec;
+			mutable std::unique_ptr<loclist> unpacked; // only once someone asks
+			unsigned refcount;
+			size_t hash;
+			std::shared_ptr<loclist_pool::table> owner;
+			pooled_loclist(packed_loclist&& packed, const spec::abstract_def& spec, size_t hash,
+				const std::shared_ptr<loclist_pool::table>& owner)
+			 : packed(std::move(packed)), spec(spec), refcount(0), hash(hash), owner(owner) {}
+		};
+		
+		const pooled_loclist *loclist_pool::intern(const loclist& l)
+		{
+			/* Every loc_expr we get is made with the same spec, in practice,
+			 * but the unpacked loclist has to come back with the one it had. */
+			const spec::abstract_def& s = l.empty() ? spec::dwarf_current : l.begin()->spec;
+			packed_loclist packed(l);
+			size_t h = packed.hash();
+			auto found = p_table->by_hash.equal_range(h);
+			for (auto i = found.first; i != found.second; ++i)
+			{
+				if (i->second->packed == packed && &i->second->spec == &s)
+				{
+					++i->second->refcount;
+					return i->second;
+				}
+			}
+			pooled_loclist *e = new pooled_loclist(std::move(packed), s, h, p_table);
+			p_table->by_hash.insert(make_pair(h, e));
+			e->refcount = 1;
+			return e;
+		}
+		void loclist_pool::acquire(const pooled_loclist *pooled)
+		{
+			++const_cast<pooled_loclist *>(pooled)->refcount;
+		}
+		void loclist_pool::release(const pooled_loclist *pooled)
+		{
+			pooled_loclist *e = const_cast<pooled_loclist *>(pooled);
+			assert(e->refcount > 0);
+			if (--e->refcount > 0) return;
+			auto found = e->owner->by_hash.equal_range(e->hash);
+			for (auto i = found.first; i != found.second; ++i)
+			{
+				if (i->second == e) { e->owner->by_hash.erase(i); break; }
+			}
+			/* This may drop the last reference to the table, if the pool
+			 * has already gone away. */
+			delete e;
+		}
+		const loclist& loclist_pool::get(const pooled_loclist *pooled)
+		{
+			if (!pooled->unpacked) pooled->unpacked.reset(new loclist(pooled->packed.unpack(pooled->spec)));
+			return *pooled->unpacked;
+		}
+		size_t loclist_pool::bytes_used() const
+		{
+			size_t total = 0;
+			for (auto i = p_table->by_hash.begin(); i != p_table->by_hash.end(); ++i)
+			{
+				total += i->second->packed.bytes_used();
+			}
+			return total;
+		}
+		
 		loc_expr loclist::loc_for_vaddr(Dwarf_Addr vaddr) const
 		{
 			for (auto i = this->begin(); i != this->end(); i++)
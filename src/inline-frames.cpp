@@ -0,0 +1,89 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * inline-frames.cpp: the stack of inlined calls at an address.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/address-index.hpp"
+#include "dwarfpp/inline-frames.hpp"
+
+namespace dwarf
+{
+	namespace core
+	{
+		static bool is_frame_tag(Dwarf_Half tag)
+		{ return tag == DW_TAG_inlined_subroutine || tag == DW_TAG_subprogram; }
+
+		Dwarf_Off inline_frame_index::resolve_origin(root_die& r, const iterator_base& i)
+		{
+			/* An inlined call's origin is the abstract subprogram, but a
+			 * concrete out-of-line instance also has one, so we follow the
+			 * chain. Bad DWARF could make it cycle; real chains are short. */
+			iterator_base cur = i;
+			for (unsigned hops = 0; hops < 8 && cur.has_attr_here(DW_AT_abstract_origin); ++hops)
+			{
+				iterator_base next = r.pos(cur.attr(DW_AT_abstract_origin).get_ref().off);
+				if (!next) break;
+				cur = next;
+			}
+			return cur.offset_here();
+		}
+
+		inline_frame_index::inline_frame_index(root_die& r) : idx(r.get_address_index())
+		{
+			frames.resize(idx.size());
+			for (address_index::node_id n = 0; n < idx.size(); ++n)
+			{
+				const address_index::node& nd = idx.get(n);
+				if (!is_frame_tag(nd.tag)) continue;
+				iterator_base i = r.pos(nd.off);
+				frame& f = frames[n];
+				f.die = nd.off;
+				f.tag = nd.tag;
+				f.origin = resolve_origin(r, i);
+				f.cu = i.enclosing_cu_offset_here();
+				f.call_file = i.has_attr_here(DW_AT_call_file)
+					? i.attr(DW_AT_call_file).get_unsigned() : 0;
+				f.call_line = i.has_attr_here(DW_AT_call_line)
+					? i.attr(DW_AT_call_line).get_unsigned() : 0;
+				f.call_column = i.has_attr_here(DW_AT_call_column)
+					? i.attr(DW_AT_call_column).get_unsigned() : 0;
+			}
+		}
+
+		vector<inline_frame_index::frame>
+		inline_frame_index::stack_from(address_index::node_id innermost) const
+		{
+			vector<frame> out;
+			for (address_index::node_id n = innermost;
+				n != address_index::NO_NODE; n = idx.get(n).parent)
+			{
+				Dwarf_Half tag = idx.get(n).tag;
+				if (!is_frame_tag(tag)) continue; // e.g. lexical blocks
+				out.push_back(frames[n]);
+				if (tag == DW_TAG_subprogram) return out;
+			}
+			/* Inlined calls with no subprogram around them are bad DWARF. */
+			out.clear();
+			return out;
+		}
+
+		unsigned inline_frame_index::inline_depth(Dwarf_Addr addr) const
+		{
+			unsigned depth = 0;
+			for (address_index::node_id n = idx.innermost(addr);
+				n != address_index::NO_NODE; n = idx.get(n).parent)
+			{
+				if (idx.get(n).tag == DW_TAG_subprogram) return depth;
+				if (idx.get(n).tag == DW_TAG_inlined_subroutine) ++depth;
+			}
+			return 0;
+		}
+	}
+}
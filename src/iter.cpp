@@ -100,6 +100,12 @@ namespace dwarf
 			if (!is_real_die_position()) return opt<string>();
 			return get_handle().get_name();
 		}
+		name_ref
+		iterator_base::name_ref_here() const
+		{
+			if (!is_real_die_position()) return name_ref();
+			return get_handle().get_name_ref();
+		}
 		opt<string>
 		iterator_base::global_name_here() const
 		{
@@ -110,6 +116,11 @@ namespace dwarf
 							 != DW_VIS_local)) return maybe_name;
 			else return opt<string>();
 		}
+		bool iterator_base::is_declaration_here() const
+		{
+			return has_attr_here(DW_AT_declaration)
+				&& attr(DW_AT_declaration).get_flag();
+		}
 		bool iterator_base::has_attr_here(Dwarf_Half attr) const
 		{
 			if (!is_real_die_position()) return false;
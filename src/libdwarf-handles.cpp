@@ -20,6 +20,8 @@
 #include "dwarfpp/dies.hpp"
 #include "dwarfpp/dies-inl.hpp"
 
+#include <mutex>
+
 namespace dwarf
 {
 	namespace core
@@ -187,6 +189,29 @@ namespace dwarf
 			this->handle = handle_type(returned);
 		}
 		
+		/* libelf and libdwarf keep a little global state, so we open and
+		 * close these one at a time; only the use is concurrent. */
+		static std::mutex worker_debug_mutex;
+		static ::Elf *begin_worker_elf(int fd)
+		{
+			std::lock_guard<std::mutex> guard(worker_debug_mutex);
+			::Elf *e = elf_begin(fd, ELF_C_READ, nullptr);
+			if (!e) throw Error(nullptr, 0);
+			return e;
+		}
+		WorkerDebug::WorkerDebug(int fd) : elf(begin_worker_elf(fd)), dbg()
+		{
+			std::lock_guard<std::mutex> guard(worker_debug_mutex);
+			try { dbg = Debug(elf); }
+			catch (...) { elf_end(elf); throw; }
+		}
+		WorkerDebug::~WorkerDebug()
+		{
+			std::lock_guard<std::mutex> guard(worker_debug_mutex);
+			dbg.handle.reset(); // dwarf_finish before the Elf goes
+			elf_end(elf);
+		}
+		
 		void 
 		Debug::deleter::operator()(raw_handle_type arg) const
 		{
@@ -229,6 +254,18 @@ namespace dwarf
 			//	<< dwarf_errormsg(current_dwarf_error) << ")" << std::endl; 
 			abort();
 		}
+		name_ref
+		Die::name_ref_here() const
+		{
+			/* dwarf_diename hands us a pointer into the string section (or,
+			 * for DW_FORM_string, into .debug_info itself), so there's
+			 * nothing to copy and nothing we need to deallocate. */
+			char *str;
+			int ret = dwarf_diename(raw_handle(), &str, &current_dwarf_error);
+			if (ret == DW_DLV_NO_ENTRY) return name_ref();
+			if (ret == DW_DLV_OK) return name_ref(str);
+			abort();
+		}
 		bool Die::has_attr_here(Dwarf_Half attr) const
 		{
 			Dwarf_Bool returned;
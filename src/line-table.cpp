@@ -0,0 +1,266 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * line-table.cpp: a CU's decoded line number program, compactly.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/line-table.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		const unsigned line_table::CHECKPOINT_INTERVAL;
+
+		static void write_uleb(vector<unsigned char>& out, Dwarf_Unsigned v)
+		{
+			do
+			{
+				unsigned char b = v & 0x7f;
+				v >>= 7;
+				if (v != 0) b |= 0x80;
+				out.push_back(b);
+			} while (v != 0);
+		}
+		static void write_sleb(vector<unsigned char>& out, Dwarf_Signed v)
+		{
+			bool more;
+			do
+			{
+				unsigned char b = v & 0x7f;
+				v >>= 7; // arithmetic shift, so we keep the sign
+				more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+				if (more) b |= 0x80;
+				out.push_back(b);
+			} while (more);
+		}
+		static Dwarf_Unsigned read_uleb(const unsigned char *& pos)
+		{
+			Dwarf_Unsigned working = 0;
+			unsigned shift = 0;
+			unsigned char b;
+			do
+			{
+				b = *pos++;
+				working |= static_cast<Dwarf_Unsigned>(b & 0x7f) << shift;
+				shift += 7;
+			} while (b & 0x80);
+			return working;
+		}
+		static Dwarf_Signed read_sleb(const unsigned char *& pos)
+		{
+			Dwarf_Unsigned working = 0;
+			unsigned shift = 0;
+			unsigned char b;
+			do
+			{
+				b = *pos++;
+				working |= static_cast<Dwarf_Unsigned>(b & 0x7f) << shift;
+				shift += 7;
+			} while (b & 0x80);
+			if (shift < 64 && (b & 0x40)) working |= ~static_cast<Dwarf_Unsigned>(0) << shift;
+			return static_cast<Dwarf_Signed>(working);
+		}
+
+		enum { IS_STMT = 1, END_SEQUENCE = 2, FILE_CHANGED = 4, COLUMN_CHANGED = 8, FLAG_BITS = 4 };
+
+		vector<line_table::row> line_table::decode(const Die& cu)
+		{
+			if (!cu.handle) return vector<row>();
+			return decode(cu.get_dbg(), cu.raw_handle());
+		}
+
+		vector<line_table::row> line_table::decode(Dwarf_Debug dbg, Dwarf_Die cu)
+		{
+			vector<row> rows;
+			LineList lines(LineList::try_construct(dbg, cu));
+			rows.reserve(lines.size());
+			for (Dwarf_Signed n = 0; n < lines.size(); ++n)
+			{
+				Dwarf_Line l = lines[n];
+				row r = { 0, 0, 0, 0, false, false };
+				Dwarf_Signed column = 0;
+				Dwarf_Bool is_stmt = 0, end_sequence = 0;
+				/* Skip any row we can't decode fully. A column of -1 means none. */
+				if (dwarf_lineaddr(l, &r.addr, &current_dwarf_error) != DW_DLV_OK
+					|| dwarf_lineno(l, &r.line, &current_dwarf_error) != DW_DLV_OK
+					|| dwarf_line_srcfileno(l, &r.file, &current_dwarf_error) != DW_DLV_OK
+					|| dwarf_lineoff(l, &column, &current_dwarf_error) != DW_DLV_OK) continue;
+				dwarf_linebeginstatement(l, &is_stmt, &current_dwarf_error);
+				dwarf_lineendsequence(l, &end_sequence, &current_dwarf_error);
+				r.column = column > 0 ? column : 0;
+				r.is_stmt = is_stmt;
+				r.end_sequence = end_sequence;
+				rows.push_back(r);
+			}
+			return rows;
+		}
+
+		vector<line_table::row> line_table::decode_at(Dwarf_Debug dbg, Dwarf_Off cu_off)
+		{
+			Dwarf_Die raw_cu;
+			if (dwarf_offdie(dbg, cu_off, &raw_cu, &current_dwarf_error) != DW_DLV_OK)
+			{ return vector<row>(); }
+			Die cu(Die::handle_type(raw_cu, Die::deleter(dbg)));
+			return decode(dbg, cu.raw_handle());
+		}
+
+		line_table::line_table(const Die& cu) : line_table(decode(cu)) {}
+		line_table::line_table(Dwarf_Debug dbg, Dwarf_Off cu_off) : line_table(decode_at(dbg, cu_off)) {}
+
+		line_table::line_table(vector<row> decoded) : nrows(0), reverse_index_built(false)
+		{
+			vector<vector<row> > seqs;
+			vector<row> cur;
+			for (auto i_r = decoded.begin(); i_r != decoded.end(); ++i_r)
+			{
+				cur.push_back(*i_r);
+				if (i_r->end_sequence) { seqs.push_back(std::move(cur)); cur.clear(); }
+			}
+			/* An unterminated sequence is bad DWARF, but we keep its rows. */
+			if (!cur.empty()) seqs.push_back(std::move(cur));
+			std::stable_sort(seqs.begin(), seqs.end(),
+				[](const vector<row>& s1, const vector<row>& s2) {
+					return s1.front().addr < s2.front().addr;
+				});
+			for (auto i_s = seqs.begin(); i_s != seqs.end(); ++i_s) add_sequence(*i_s);
+			Dwarf_Addr running = 0;
+			for (auto i_s = sequences.begin(); i_s != sequences.end(); ++i_s)
+			{
+				running = std::max(running, i_s->hi);
+				max_hi.push_back(running);
+			}
+		}
+
+		void line_table::add_sequence(const vector<row>& rows)
+		{
+			sequence s = { rows.front().addr, rows.back().addr, (unsigned) checkpoints.size(), 0 };
+			row prev = rows.front();
+			unsigned since_checkpoint = 0;
+			for (auto i_r = rows.begin(); i_r != rows.end(); ++i_r)
+			{
+				Dwarf_Addr delta = i_r->addr - prev.addr;
+				/* Addresses shouldn't go backwards within a sequence, and the
+				 * delta must leave room for the flags; if not, checkpoint. */
+				if (i_r == rows.begin() || since_checkpoint == CHECKPOINT_INTERVAL
+					|| i_r->addr < prev.addr || (delta >> (64 - FLAG_BITS)) != 0)
+				{
+					checkpoints.push_back(*i_r);
+					offsets.push_back(bytes.size());
+					since_checkpoint = 1;
+					prev = *i_r;
+					continue;
+				}
+				unsigned flags = (i_r->is_stmt ? IS_STMT : 0)
+					| (i_r->end_sequence ? END_SEQUENCE : 0)
+					| (i_r->file != prev.file ? FILE_CHANGED : 0)
+					| (i_r->column != prev.column ? COLUMN_CHANGED : 0);
+				write_uleb(bytes, (delta << FLAG_BITS) | flags);
+				write_sleb(bytes, static_cast<Dwarf_Signed>(i_r->line - prev.line));
+				if (flags & FILE_CHANGED) write_uleb(bytes, i_r->file);
+				if (flags & COLUMN_CHANGED) write_uleb(bytes, i_r->column);
+				++since_checkpoint;
+				prev = *i_r;
+			}
+			s.end_checkpoint = checkpoints.size();
+			nrows += rows.size();
+			sequences.push_back(s);
+		}
+
+		template <typename F>
+		void line_table::decode_block(unsigned k, F f) const
+		{
+			row cur = checkpoints[k];
+			if (!f(cur)) return;
+			const unsigned char *pos = bytes.data() + offsets[k];
+			const unsigned char *end = bytes.data()
+				+ ((k + 1 < offsets.size()) ? offsets[k + 1] : bytes.size());
+			while (pos != end)
+			{
+				Dwarf_Unsigned header = read_uleb(pos);
+				cur.addr += header >> FLAG_BITS;
+				cur.is_stmt = header & IS_STMT;
+				cur.end_sequence = header & END_SEQUENCE;
+				cur.line += read_sleb(pos);
+				if (header & FILE_CHANGED) cur.file = read_uleb(pos);
+				if (header & COLUMN_CHANGED) cur.column = read_uleb(pos);
+				if (!f(cur)) return;
+			}
+		}
+
+		opt<line_table::row> line_table::find(Dwarf_Addr addr, Dwarf_Addr *out_until) const
+		{
+			unsigned k = std::upper_bound(sequences.begin(), sequences.end(), addr,
+				[](Dwarf_Addr a, const sequence& s) { return a < s.lo; }) - sequences.begin();
+			/* A later sequence starting after addr takes over from wherever
+			 * we find addr. */
+			Dwarf_Addr until = (k < sequences.size()) ? sequences[k].lo : ~static_cast<Dwarf_Addr>(0);
+			if (out_until) *out_until = addr + 1; // unless we find better
+			while (k > 0 && max_hi[k - 1] > addr)
+			{
+				const sequence& s = sequences[--k];
+				if (addr >= s.hi) continue;
+				/* The last checkpoint at or before addr. There is one, since
+				 * the sequence's first row is a checkpoint. */
+				unsigned c = std::upper_bound(checkpoints.begin() + s.first_checkpoint,
+					checkpoints.begin() + s.end_checkpoint, addr,
+					[](Dwarf_Addr a, const row& r) { return a < r.addr; }) - checkpoints.begin() - 1;
+				opt<row> found;
+				Dwarf_Addr next = (c + 1 < s.end_checkpoint) ? checkpoints[c + 1].addr : s.hi;
+				decode_block(c, [addr, &found, &next](const row& r) {
+					if (r.addr > addr) { next = r.addr; return false; }
+					found = r;
+					return true;
+				});
+				if (out_until) *out_until = std::min(next, until);
+				return found;
+			}
+			return opt<row>();
+		}
+
+		void line_table::build_reverse_index() const
+		{
+			for (unsigned k = 0; k < checkpoints.size(); ++k)
+			{
+				decode_block(k, [this](const row& r) {
+					if (r.end_sequence || !r.is_stmt) return true;
+					vector<Dwarf_Addr>& addrs = by_file_and_line[make_pair(r.file, r.line)];
+					if (addrs.empty() || addrs.back() != r.addr) addrs.push_back(r.addr);
+					return true;
+				});
+			}
+			for (auto i_e = by_file_and_line.begin(); i_e != by_file_and_line.end(); ++i_e)
+			{
+				std::sort(i_e->second.begin(), i_e->second.end());
+				i_e->second.erase(std::unique(i_e->second.begin(), i_e->second.end()),
+					i_e->second.end());
+			}
+			reverse_index_built = true;
+		}
+
+		vector<Dwarf_Addr> line_table::addresses_for(Dwarf_Unsigned file, Dwarf_Unsigned line) const
+		{
+			if (!reverse_index_built) build_reverse_index();
+			auto found = by_file_and_line.find(make_pair(file, line));
+			return (found == by_file_and_line.end()) ? vector<Dwarf_Addr>() : found->second;
+		}
+
+		vector<line_table::row> line_table::all_rows() const
+		{
+			vector<row> out;
+			out.reserve(nrows);
+			for (unsigned k = 0; k < checkpoints.size(); ++k)
+			{
+				decode_block(k, [&out](const row& r) { out.push_back(r); return true; });
+			}
+			return out;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * name-dictionary.cpp: every DIE name, sorted, for pattern searches.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include <fnmatch.h>
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/name-dictionary.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	namespace core
+	{
+		name_dictionary::name_dictionary(root_die& r) : r(r)
+		{
+			struct named { root_die::name_atom a; entry e; };
+			vector<named> found;
+			root_die::name_atom max_atom = root_die::NO_NAME_ATOM;
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				if (!i.is_real_die_position()) continue;
+				name_ref name = i.name_ref_here();
+				if (name.empty()) continue;
+				named n = { r.intern_name(name), { i.offset_here(), i.tag_here() } };
+				max_atom = std::max(max_atom, n.a);
+				found.push_back(n);
+			}
+			/* Atoms are small and dense, so we can rank them in a vector. */
+			vector<unsigned> count(max_atom + 1, 0);
+			for (auto i_f = found.begin(); i_f != found.end(); ++i_f)
+			{
+				if (count[i_f->a]++ == 0) names.push_back(i_f->a);
+			}
+			std::sort(names.begin(), names.end(),
+				[&r](root_die::name_atom a1, root_die::name_atom a2) {
+					return r.name_for_atom(a1) < r.name_for_atom(a2);
+				});
+			vector<unsigned> next(max_atom + 1, 0);
+			unsigned total = 0;
+			for (auto i_n = names.begin(); i_n != names.end(); ++i_n)
+			{
+				first_entry.push_back(total);
+				next[*i_n] = total;
+				total += count[*i_n];
+			}
+			first_entry.push_back(total);
+			/* Placing each in turn keeps file order within a name. */
+			entries.resize(total);
+			for (auto i_f = found.begin(); i_f != found.end(); ++i_f)
+			{
+				entries[next[i_f->a]++] = i_f->e;
+			}
+		}
+
+		pair<unsigned, unsigned> name_dictionary::prefix_range(name_ref prefix) const
+		{
+			auto lo = std::lower_bound(names.begin(), names.end(), prefix,
+				[this](root_die::name_atom a, name_ref p) { return r.name_for_atom(a) < p; });
+			auto hi = std::upper_bound(lo, names.end(), prefix,
+				[this](name_ref p, root_die::name_atom a) {
+					return p < r.name_for_atom(a).substr(0, p.size());
+				});
+			return std::make_pair(lo - names.begin(), hi - names.begin());
+		}
+
+		void name_dictionary::append_entries(unsigned n, Dwarf_Half tag,
+			vector<Dwarf_Off>& out) const
+		{
+			for (unsigned k = first_entry[n]; k != first_entry[n + 1]; ++k)
+			{
+				if (!tag || entries[k].tag == tag) out.push_back(entries[k].off);
+			}
+		}
+
+		vector<Dwarf_Off> name_dictionary::exact(const string& name, Dwarf_Half tag) const
+		{
+			vector<Dwarf_Off> out;
+			auto found = std::lower_bound(names.begin(), names.end(), name_ref(name),
+				[this](root_die::name_atom a, name_ref n) { return r.name_for_atom(a) < n; });
+			if (found != names.end() && r.name_for_atom(*found) == name_ref(name))
+			{
+				append_entries(found - names.begin(), tag, out);
+			}
+			return out;
+		}
+
+		vector<Dwarf_Off> name_dictionary::with_prefix(const string& prefix, Dwarf_Half tag) const
+		{
+			vector<Dwarf_Off> out;
+			pair<unsigned, unsigned> range = prefix_range(name_ref(prefix));
+			for (unsigned n = range.first; n != range.second; ++n) append_entries(n, tag, out);
+			return out;
+		}
+
+		vector<Dwarf_Off> name_dictionary::matching_glob(const string& pattern, Dwarf_Half tag) const
+		{
+			vector<Dwarf_Off> out;
+			string literal = pattern.substr(0, pattern.find_first_of("*?[\\"));
+			pair<unsigned, unsigned> range = prefix_range(name_ref(literal));
+			for (unsigned n = range.first; n != range.second; ++n)
+			{
+				/* Our names are the root's interned std::strings, so they
+				 * are NUL-terminated. */
+				if (fnmatch(pattern.c_str(), name_at(n).data(), 0) == 0) append_entries(n, tag, out);
+			}
+			return out;
+		}
+
+		vector<Dwarf_Off> name_dictionary::matching_regex(const boost::regex& re, Dwarf_Half tag) const
+		{
+			vector<Dwarf_Off> out;
+			for (unsigned n = 0; n != names.size(); ++n)
+			{
+				name_ref name = name_at(n);
+				if (boost::regex_match(name.begin(), name.end(), re)) append_entries(n, tag, out);
+			}
+			return out;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * packed-expr.cpp: location lists flattened into a single byte buffer.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/packed-expr.hpp"
+
+namespace dwarf
+{
+	namespace encap
+	{
+		static void write_uleb(vector<unsigned char>& out, Dwarf_Unsigned v)
+		{
+			do
+			{
+				unsigned char b = v & 0x7f;
+				v >>= 7;
+				if (v != 0) b |= 0x80;
+				out.push_back(b);
+			} while (v != 0);
+		}
+		static void write_sleb(vector<unsigned char>& out, Dwarf_Signed v)
+		{
+			bool more;
+			do
+			{
+				unsigned char b = v & 0x7f;
+				v >>= 7; // arithmetic shift, so we keep the sign
+				more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+				if (more) b |= 0x80;
+				out.push_back(b);
+			} while (more);
+		}
+
+		packed_loclist::packed_loclist(const loclist& l) : nentries(0)
+		{
+			vector<unsigned char> body;
+			for (auto i_expr = l.begin(); i_expr != l.end(); ++i_expr)
+			{
+				body.clear();
+				Dwarf_Unsigned prev_offset = 0;
+				for (auto i_instr = i_expr->begin(); i_instr != i_expr->end(); ++i_instr)
+				{
+					body.push_back(i_instr->lr_atom);
+					unsigned char which = (i_instr->lr_number ? 1 : 0) | (i_instr->lr_number2 ? 2 : 0);
+					body.push_back(which);
+					/* Offsets normally increase; if they don't, we still
+					 * round-trip, since the delta just wraps. */
+					write_uleb(body, i_instr->lr_offset - prev_offset);
+					prev_offset = i_instr->lr_offset;
+					if (which & 1) write_sleb(body, static_cast<Dwarf_Signed>(i_instr->lr_number));
+					if (which & 2) write_sleb(body, static_cast<Dwarf_Signed>(i_instr->lr_number2));
+				}
+				const unsigned char *lopc_bytes = reinterpret_cast<const unsigned char *>(&i_expr->lopc);
+				const unsigned char *hipc_bytes = reinterpret_cast<const unsigned char *>(&i_expr->hipc);
+				bytes.insert(bytes.end(), lopc_bytes, lopc_bytes + sizeof i_expr->lopc);
+				bytes.insert(bytes.end(), hipc_bytes, hipc_bytes + sizeof i_expr->hipc);
+				write_uleb(bytes, body.size());
+				bytes.insert(bytes.end(), body.begin(), body.end());
+				++nentries;
+			}
+			bytes.shrink_to_fit();
+		}
+
+		loclist packed_loclist::unpack(const spec::abstract_def& spec /* = spec::dwarf_current */) const
+		{
+			loclist l;
+			for (auto i = begin(); i != end(); ++i) l.push_back(i->unpack(spec));
+			return l;
+		}
+	}
+}
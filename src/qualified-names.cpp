@@ -0,0 +1,130 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * qualified-names.cpp: a whole-file trie of qualified names.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/qualified-names.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		constexpr qualified_name_index::node_id qualified_name_index::ROOT_NODE;
+		const vector<Dwarf_Off> qualified_name_index::no_dies;
+
+		qualified_name_index::qualified_name_index(root_die& r) : r(r)
+		{
+			node root_node = { root_die::NO_NAME_ATOM, ROOT_NODE, {}, {} };
+			nodes.push_back(std::move(root_node));
+			auto cu_seq = r.children();
+			for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+			{
+				spec& s = i_cu.base().spec_here();
+				auto children = i_cu.base().children_here();
+				for (auto i = std::move(children.first); i != children.second; ++i)
+				{
+					/* As for the visible grandchildren, local things are
+					 * not reachable from the root. */
+					if (i.has_attr_here(DW_AT_visibility)
+						&& i.attr(DW_AT_visibility).get_unsigned() == DW_VIS_local) continue;
+					name_ref name = i.name_ref_here();
+					if (name.empty()) continue;
+					node_id c = child_node(ROOT_NODE, r.intern_name(name));
+					nodes[c].dies.push_back(i.offset_here());
+					if (s.tag_has_named_children(i.tag_here())) add_children(i, c, s);
+				}
+			}
+		}
+
+		qualified_name_index::node_id
+		qualified_name_index::child_node(node_id parent, root_die::name_atom component)
+		{
+			auto found = edges.find(edge(parent, component));
+			if (found != edges.end()) return found->second;
+			node_id n = nodes.size();
+			node new_node = { component, parent, {}, {} };
+			nodes.push_back(std::move(new_node)); // may move nodes, so no references held
+			nodes[parent].children.push_back(n);
+			edges.insert(make_pair(edge(parent, component), n));
+			return n;
+		}
+
+		void qualified_name_index::add_children(const iterator_base& scope, node_id n, spec& s)
+		{
+			Dwarf_Off scope_off = scope.offset_here();
+			scopes.insert(scope_off);
+			auto children = scope.children_here();
+			for (auto i = std::move(children.first); i != children.second; ++i)
+			{
+				name_ref name = i.name_ref_here();
+				if (name.empty()) continue;
+				root_die::name_atom a = r.intern_name(name);
+				node_id c = child_node(n, a);
+				nodes[c].dies.push_back(i.offset_here());
+				/* Children come in order, so the first insert is the first child. */
+				first_named.insert(make_pair(scoped_name(scope_off, a), i.offset_here()));
+				if (s.tag_has_named_children(i.tag_here())) add_children(i, c, s);
+			}
+		}
+
+		vector<string>
+		qualified_name_index::split(const string& qualified, const string& sep)
+		{
+			vector<string> path;
+			if (sep.empty()) { path.push_back(qualified); return path; }
+			int nesting = 0;
+			string::size_type start = 0;
+			for (string::size_type pos = 0; pos < qualified.size(); )
+			{
+				char c = qualified[pos];
+				if (c == '<' || c == '(') ++nesting;
+				else if ((c == '>' || c == ')') && nesting > 0) --nesting;
+				if (nesting == 0 && qualified.compare(pos, sep.size(), sep) == 0)
+				{
+					path.push_back(qualified.substr(start, pos - start));
+					pos += sep.size();
+					start = pos;
+				}
+				else ++pos;
+			}
+			path.push_back(qualified.substr(start));
+			return path;
+		}
+
+		vector<Dwarf_Off> qualified_name_index::all_under(node_id n) const
+		{
+			vector<Dwarf_Off> out;
+			vector<node_id> to_visit(nodes.at(n).children);
+			while (!to_visit.empty())
+			{
+				const node& cur = nodes[to_visit.back()];
+				to_visit.pop_back();
+				out.insert(out.end(), cur.dies.begin(), cur.dies.end());
+				to_visit.insert(to_visit.end(), cur.children.begin(), cur.children.end());
+			}
+			return out;
+		}
+
+		vector<string> qualified_name_index::path_of(node_id n) const
+		{
+			vector<string> path;
+			for (; n != ROOT_NODE; n = nodes.at(n).parent)
+			{
+				path.push_back(component_of(n).to_string());
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+	}
+}
@@ -0,0 +1,79 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * reverse-refs.cpp: which DIEs refer to a given DIE.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/reverse-refs.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace dwarf
+{
+	namespace core
+	{
+		reverse_reference_index::reverse_reference_index(root_die& r)
+		{
+			r.index_all_references();
+			const auto& refers_to = r.get_refers_to();
+
+			/* Flip each (source, attr) -> target, then sort by target. The
+			 * forward map is already in (source, attr) order, so a stable
+			 * sort leaves each target's edges in that order too. */
+			vector<std::tuple<Dwarf_Off, Dwarf_Off, Dwarf_Half> > flipped;
+			flipped.reserve(refers_to.size());
+			for (auto i_ref = refers_to.begin(); i_ref != refers_to.end(); ++i_ref)
+			{
+				if (i_ref->first.second == DW_AT_sibling) continue;
+				flipped.push_back(std::make_tuple(i_ref->second,
+					i_ref->first.first, i_ref->first.second));
+			}
+			std::stable_sort(flipped.begin(), flipped.end(),
+				[](const std::tuple<Dwarf_Off, Dwarf_Off, Dwarf_Half>& t1,
+				   const std::tuple<Dwarf_Off, Dwarf_Off, Dwarf_Half>& t2) {
+					return std::get<0>(t1) < std::get<0>(t2);
+				});
+
+			edges.reserve(flipped.size());
+			for (auto i_f = flipped.begin(); i_f != flipped.end(); ++i_f)
+			{
+				if (targets.empty() || targets.back() != std::get<0>(*i_f))
+				{
+					targets.push_back(std::get<0>(*i_f));
+					first_edge.push_back(edges.size());
+				}
+				edge e = { std::get<1>(*i_f), std::get<2>(*i_f) };
+				edges.push_back(e);
+			}
+			first_edge.push_back(edges.size());
+		}
+
+		pair<reverse_reference_index::edge_iterator, reverse_reference_index::edge_iterator>
+		reverse_reference_index::referrers(Dwarf_Off target) const
+		{
+			auto found = std::lower_bound(targets.begin(), targets.end(), target);
+			if (found == targets.end() || *found != target)
+			{
+				return std::make_pair(edge_iterator(nullptr), edge_iterator(nullptr));
+			}
+			unsigned k = found - targets.begin();
+			return std::make_pair(edges.data() + first_edge[k], edges.data() + first_edge[k + 1]);
+		}
+
+		vector<Dwarf_Off>
+		reverse_reference_index::referrers(Dwarf_Off target, Dwarf_Half attr) const
+		{
+			vector<Dwarf_Off> out;
+			auto rs = referrers(target);
+			for (auto i_e = rs.first; i_e != rs.second; ++i_e)
+			{
+				if (i_e->attr == attr) out.push_back(i_e->source);
+			}
+			return out;
+		}
+	}
+}
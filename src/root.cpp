@@ -11,11 +11,32 @@
 #include "dwarfpp/iter.hpp"
 #include "dwarfpp/iter-inl.hpp"
 #include "dwarfpp/frame.hpp"
+#include "dwarfpp/qualified-names.hpp"
+#include "dwarfpp/address-index.hpp"
+#include "dwarfpp/inline-frames.hpp"
+#include "dwarfpp/type-names.hpp"
+#include "dwarfpp/symbols.hpp"
+#include "dwarfpp/name-dictionary.hpp"
+#include "dwarfpp/demangled-names.hpp"
+#include "dwarfpp/line-table.hpp"
+#include "dwarfpp/util.hpp"
 
+#include <gelf.h>
+#include <cstring>
+#include <memory>
 #include <iostream>
+#include <algorithm>
 #include <srk31/indenting_ostream.hpp>
 #include <srk31/algorithm.hpp>
 
+/* Older libdwarfs' dwarf.h predate DWARF 5's name index. */
+#ifndef DW_IDX_compile_unit
+#define DW_IDX_compile_unit 1
+#define DW_IDX_type_unit 2
+#define DW_IDX_die_offset 3
+#define DW_IDX_parent 4
+#endif
+
 namespace dwarf
 {
 	using std::endl;
@@ -100,60 +121,106 @@ namespace dwarf
 				if (found == m.end()) m.insert(make_pair(i_attr->first, i_attr->second));
 			}
 		}
-		/* The same, but seeing through DW_AT_abstract_origin and DW_AT_specification references. */
+		/* The same, but seeing through DW_AT_abstract_origin and DW_AT_specification references. 
+		 * Following those references means building iterators and maybe searching,
+		 * and C++ code asks this repeatedly of the same inlined subprograms, so we
+		 * keep the result in the payload if the root lets us. */
 		encap::attribute_map basic_die::find_all_attrs() const
+		{
+			if (cached_found_attrs) return *cached_found_attrs;
+			encap::attribute_map m = compute_found_attrs();
+			if (get_root().caches_found_attrs(*this))
+			{
+				cached_found_attrs.reset(new encap::attribute_map(m));
+			}
+			return m;
+		}
+		/* We merge with the *found* attributes of what we refer to, so that
+		 * the view agrees with find_attr(), which is recursive. That matters for
+		 * C++ inlined instances, whose abstract origin in turn has a specification. */
+		encap::attribute_map basic_die::compute_found_attrs() const
 		{
 			encap::attribute_map m = copy_attrs();
 			// merge with attributes of abstract_origin and specification
+			auto link = attr_link();
+			switch (link.first)
+			{
+				case DW_AT_abstract_origin:
+				case DW_AT_declaration:
+					left_merge_attrs(m, get_root().pos(link.second)->find_all_attrs());
+					break;
+				case DW_AT_specification:
+					// as in find_attr, we don't recurse: declarations don't chain
+					left_merge_attrs(m, get_root().pos(link.second)->all_attrs());
+					break;
+				default: break;
+			}
+			return m;
+		}
+		/* Working out the link means decoding a reference attribute, or for
+		 * a declaration, searching for the definition. Asking find_attr()
+		 * for several attributes of the same DIE would redo that each time,
+		 * so we remember the answer, though not the merged view. */
+		pair<Dwarf_Half, Dwarf_Off> basic_die::attr_link() const
+		{
+			if (cached_attr_link) return *cached_attr_link;
+			pair<Dwarf_Half, Dwarf_Off> link(0, 0UL);
 			if (has_attr(DW_AT_abstract_origin))
 			{
-				encap::attribute_map origin_m = attr(DW_AT_abstract_origin).get_refiter()->all_attrs();
-				left_merge_attrs(m, origin_m);
+				link = make_pair(DW_AT_abstract_origin, attr(DW_AT_abstract_origin).get_refoff());
 			}
 			else if (has_attr(DW_AT_specification))
 			{
-				encap::attribute_map origin_m = attr(DW_AT_specification).get_refiter()->all_attrs();
-				left_merge_attrs(m, origin_m);
+				link = make_pair(DW_AT_specification, attr(DW_AT_specification).get_refoff());
 			}
 			else if (has_attr(DW_AT_declaration))
 			{
-				/* How do we get to the "real" DIE from this specification? The 
-				 * specification attr doesn't tell us, so we have to search. */
+				/* How do we get to the "real" DIE from this declaration? The 
+				 * declaration attr doesn't tell us, so we have to search.. */
 				iterator_df<> found = find_definition();
-				if (found) left_merge_attrs(m, found->all_attrs());
+				if (found && found.offset_here() != get_offset())
+				{
+					link = make_pair(DW_AT_declaration, found.offset_here());
+				}
 			}
-			return m;
+			if (get_root().caches_found_attrs(*this)) cached_attr_link = link;
+			return link;
 		}
 		encap::attribute_value basic_die::find_attr(Dwarf_Half a) const
 		{
-			if (has_attr(a)) { return attr(a); }
-			else if (has_attr(DW_AT_abstract_origin))
+			/* If someone has already built the merged view, just look it up.
+			 * We don't build it here: that would decode every attribute, and
+			 * search for a definition, to answer a question that our own
+			 * attributes usually answer. */
+			if (cached_found_attrs)
 			{
-				return attr(DW_AT_abstract_origin).get_refiter()->find_attr(a);
+				auto found = cached_found_attrs->find(a);
+				if (found != cached_found_attrs->end()) return found->second;
+				return encap::attribute_value();
 			}
-			else if (has_attr(DW_AT_specification))
+			if (has_attr(a)) { return attr(a); }
+			auto link = attr_link();
+			switch (link.first)
 			{
-				/* For the purposes of this algorithm, if a debugging information entry S has a
-				   DW_AT_specification attribute that refers to another entry D (which has a 
-				   DW_AT_declaration attribute), then S inherits the attributes and children of D, 
-				   and S is processed as if those attributes and children were present in the 
-				   entry S. Exception: if a particular attribute is found in both S and D, the 
-				   attribute in S is used and the corresponding one in D is ignored.
-				 */
-				// FIXME: handle children similarly!
-
-				// NOTE: we don't find_attr because I don't think chains of s->d->d->d-> 
-				// are allowed.
+				case DW_AT_abstract_origin:
+				case DW_AT_declaration:
+					return get_root().pos(link.second)->find_attr(a);
+				case DW_AT_specification: {
+					/* For the purposes of this algorithm, if a debugging information entry S has a
+					   DW_AT_specification attribute that refers to another entry D (which has a 
+					   DW_AT_declaration attribute), then S inherits the attributes and children of D, 
+					   and S is processed as if those attributes and children were present in the 
+					   entry S. Exception: if a particular attribute is found in both S and D, the 
+					   attribute in S is used and the corresponding one in D is ignored.
+					 */
+					// FIXME: handle children similarly!
 
-				auto decl = attr(DW_AT_specification).get_refiter();
-				if (decl.has_attr(a)) return decl->attr(a);
-			}
-			else if (has_attr(DW_AT_declaration))
-			{
-				/* How do we get to the "real" DIE from this declaration? The 
-				 * declaration attr doesn't tell us, so we have to search.. */
-				iterator_df<> found = find_definition();
-				if (found && found.offset_here() != get_offset()) return found->find_attr(a);
+					// NOTE: we don't find_attr because I don't think chains of s->d->d->d-> 
+					// are allowed.
+					auto decl = get_root().pos(link.second);
+					if (decl.has_attr(a)) return decl->attr(a);
+				} break;
+				default: break;
 			}
 			return encap::attribute_value(); // a.k.a. a NO_ATTR-valued attribute_value
 		}
@@ -169,11 +236,31 @@ namespace dwarf
 // 			} else return find_self();
 		}
 		
+		/* Not inline: destroying the unique_ptrs, should a later member's
+		 * initialiser throw, needs their pointees' types. */
+		root_die::root_die() : dbg(), visible_named_grandchildren_is_complete(false),
+			name_tables_loaded(false), name_tables_complete(false), p_fs(nullptr), p_qualified_names(),
+			p_address_index(), p_inline_frames(), p_cu_ranges(), p_static_data_index(), p_type_names(),
+			p_symbols(), p_name_dictionary(), p_demangled_names(),
+			current_cu_offset(0), returned_elf(nullptr), opened_fd(-1), index_workers(0) {}
+
 		root_die::root_die(int fd)
 		 :  dbg(fd), 
 			visible_named_grandchildren_is_complete(false),
+			name_tables_loaded(false),
+			name_tables_complete(false),
 			p_fs(new FrameSection(get_dbg(), true)), 
+			p_qualified_names(),
+			p_address_index(),
+			p_inline_frames(),
+			p_cu_ranges(),
+			p_static_data_index(),
+			p_type_names(),
+			p_symbols(),
+			p_name_dictionary(),
+			p_demangled_names(),
 			current_cu_offset(0UL), returned_elf(nullptr), 
+			opened_fd(fd), index_workers(0),
 			first_cu_offset(),
 			last_seen_cu_header_length(),
 			last_seen_version_stamp(),
@@ -184,7 +271,10 @@ namespace dwarf
 			last_seen_next_cu_header()
 		{ assert(p_fs != 0); }
 		
-		root_die::~root_die() { delete p_fs; }
+		root_die::~root_die()
+		{
+			delete p_fs;
+		}
 		
 		::Elf *root_die::get_elf()
 		{
@@ -350,17 +440,572 @@ namespace dwarf
 		iterator_base
 		root_die::find_named_child(const iterator_base& start, const string& name)
 		{
-			auto children = start.children_here();
-			for (auto i_child = std::move(children.first); i_child != children.second; ++i_child)
+			/* Unnamed children aren't named "", so nothing is. */
+			if (name.empty()) return iterator_base::END;
+			Dwarf_Off scope_off = start.offset_here();
+			auto found_index = child_name_indexes.find(scope_off);
+			if (found_index == child_name_indexes.end())
+			{
+				/* First lookup in this scope. Gather the children's names
+				 * in place, without copying, and answer from those. Only
+				 * if there are enough of them do we intern and hash them. */
+				std::vector<pair<name_ref, Dwarf_Off> > named;
+				auto children = start.children_here();
+				for (auto i_child = std::move(children.first); i_child != children.second; ++i_child)
+				{
+					name_ref n = i_child.name_ref_here();
+					if (!n.empty()) named.push_back(make_pair(n, i_child.offset_here()));
+				}
+				child_name_index idx;
+				idx.linear = (named.size() < MIN_HASHED_CHILDREN);
+				if (!idx.linear)
+				{
+					for (auto i_named = named.begin(); i_named != named.end(); ++i_named)
+					{
+						idx.first_named.insert(make_pair(intern_name(i_named->first), i_named->second));
+					}
+				}
+				child_name_indexes.insert(make_pair(scope_off, std::move(idx)));
+				for (auto i_named = named.begin(); i_named != named.end(); ++i_named)
+				{
+					if (i_named->first == name_ref(name))
+					{
+						return pos(i_named->second, start.depth() + 1, scope_off);
+					}
+				}
+				return iterator_base::END;
+			}
+			if (found_index->second.linear)
+			{
+				auto children = start.children_here();
+				for (auto i_child = std::move(children.first); i_child != children.second; ++i_child)
+				{
+					/* Compare in place; no need to copy each child's name.
+					 * As above, unnamed children never match. */
+					name_ref n = i_child.name_ref_here();
+					if (!n.empty() && n == name_ref(name))
+					{
+						return std::move(i_child);
+					}
+				}
+				return iterator_base::END;
+			}
+			/* A name nobody has interned can't be in the index. */
+			auto found = found_index->second.first_named.find(find_name_atom(name_ref(name)));
+			if (found == found_index->second.first_named.end()) return iterator_base::END;
+			return pos(found->second, start.depth() + 1, scope_off);
+		}
+		
+		void root_die::cache_visible_named_grandchild(name_atom a, Dwarf_Off off)
+		{
+			std::vector<Dwarf_Off>& offs = visible_named_grandchildren_cache[a];
+			if (std::find(offs.begin(), offs.end(), off) == offs.end()) offs.push_back(off);
+		}
+
+		/* Each CU's share of the index is gathered separately, as name_refs
+		 * which need no copying, and merged (interned) afterwards. Given
+		 * workers, each CU is walked on one of them, straight through
+		 * libdwarf with the worker's own Dwarf_Debug: our iterators update
+		 * the root's payload and live-DIE tables, which aren't locked. The
+		 * names point into the workers' copies of the string sections, so
+		 * the workers' Debugs must stay open until we've interned them. */
+		static void
+		gather_visible_named_children(const iterator_base& cu,
+			std::vector<pair<name_ref, Dwarf_Off> >& out)
+		{
+			auto children = cu.children_here();
+			for (auto i = std::move(children.first); i != children.second; ++i)
+			{
+				name_ref n = i.name_ref_here();
+				if (n.empty()) continue;
+				if (i.has_attr_here(DW_AT_visibility)
+					&& i.attr(DW_AT_visibility).get_unsigned() == DW_VIS_local) continue;
+				out.push_back(make_pair(n, i.offset_here()));
+			}
+		}
+		static void
+		gather_visible_named_children(Dwarf_Debug dbg, Dwarf_Off cu_off,
+			std::vector<pair<name_ref, Dwarf_Off> >& out)
+		{
+			Dwarf_Die cu;
+			if (dwarf_offdie(dbg, cu_off, &cu, &current_dwarf_error) != DW_DLV_OK)
+			{ throw Error(current_dwarf_error, 0); }
+			Dwarf_Die child;
+			int ret = dwarf_child(cu, &child, &current_dwarf_error);
+			dwarf_dealloc(dbg, cu, DW_DLA_DIE);
+			while (ret == DW_DLV_OK)
+			{
+				char *str;
+				Dwarf_Off off;
+				if (dwarf_diename(child, &str, &current_dwarf_error) == DW_DLV_OK && *str
+					&& dwarf_dieoffset(child, &off, &current_dwarf_error) == DW_DLV_OK)
+				{
+					bool local = false;
+					Dwarf_Attribute a;
+					if (dwarf_attr(child, DW_AT_visibility, &a, &current_dwarf_error) == DW_DLV_OK)
+					{
+						Dwarf_Unsigned vis;
+						local = (dwarf_formudata(a, &vis, &current_dwarf_error) == DW_DLV_OK
+							&& vis == DW_VIS_local);
+						dwarf_dealloc(dbg, a, DW_DLA_ATTR);
+					}
+					if (!local) out.push_back(make_pair(name_ref(str), off));
+				}
+				Dwarf_Die next;
+				ret = dwarf_siblingof(dbg, child, &next, &current_dwarf_error);
+				dwarf_dealloc(dbg, child, DW_DLA_DIE);
+				child = next;
+			}
+			if (ret == DW_DLV_ERROR) throw Error(current_dwarf_error, 0);
+		}
+		void root_die::index_visible_named_grandchildren()
+		{
+			if (visible_named_grandchildren_is_complete) return;
+			std::vector<std::vector<pair<name_ref, Dwarf_Off> > > per_cu;
+			unsigned nworkers = index_worker_count();
+			std::vector<std::unique_ptr<WorkerDebug> > workers(nworkers);
+			auto cu_seq = children();
+			if (nworkers > 1)
+			{
+				std::vector<Dwarf_Off> cu_offs;
+				for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+				{
+					cu_offs.push_back(i_cu.offset_here());
+				}
+				per_cu.resize(cu_offs.size());
+				parallel_for(cu_offs.size(), nworkers,
+					[this, &cu_offs, &per_cu, &workers](unsigned n, unsigned w) {
+						if (!workers[w]) workers[w].reset(new WorkerDebug(opened_fd));
+						gather_visible_named_children(workers[w]->raw_handle(), cu_offs[n], per_cu[n]);
+					});
+			}
+			else for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+			{
+				per_cu.emplace_back();
+				gather_visible_named_children(i_cu.base(), per_cu.back());
+			}
+			size_t total = 0;
+			for (auto i_cu = per_cu.begin(); i_cu != per_cu.end(); ++i_cu) total += i_cu->size();
+			/* Anything already cached is a visible grandchild, so will
+			 * turn up again. */
+			visible_named_grandchildren_cache.clear();
+			visible_named_grandchildren_cache.reserve(total);
+			for (auto i_cu = per_cu.begin(); i_cu != per_cu.end(); ++i_cu)
+			{
+				for (auto i_pair = i_cu->begin(); i_pair != i_cu->end(); ++i_pair)
+				{
+					cache_visible_named_grandchild(intern_name(i_pair->first), i_pair->second);
+				}
+			}
+			visible_named_grandchildren_is_complete = true;
+		}
+
+		bool root_die::has_in_memory_dies() const
+		{
+			for (auto i_live = live_dies.begin(); i_live != live_dies.end(); ++i_live)
+			{
+				if (!i_live->second->d.handle) return true;
+			}
+			return false;
+		}
+		unsigned root_die::index_worker_count() const
+		{
+			if (opened_fd == -1 || has_in_memory_dies()) return 1;
+			return index_thread_limit();
+		}
+
+		const qualified_name_index& root_die::get_qualified_name_index()
+		{
+			if (!p_qualified_names) p_qualified_names.reset(new qualified_name_index(*this));
+			return *p_qualified_names;
+		}
+		void root_die::forget_qualified_names()
+		{
+			p_qualified_names.reset();
+		}
+
+		const address_index& root_die::get_address_index()
+		{
+			if (!p_address_index) p_address_index.reset(new address_index(*this));
+			return *p_address_index;
+		}
+		void root_die::forget_address_index()
+		{
+			forget_inline_frames();
+			p_address_index.reset();
+		}
+
+		const inline_frame_index& root_die::get_inline_frame_index()
+		{
+			if (!p_inline_frames) p_inline_frames.reset(new inline_frame_index(*this));
+			return *p_inline_frames;
+		}
+		void root_die::forget_inline_frames()
+		{
+			p_inline_frames.reset();
+		}
+
+		const cu_range_index& root_die::get_cu_range_index()
+		{
+			if (!p_cu_ranges) p_cu_ranges.reset(new cu_range_index(*this));
+			return *p_cu_ranges;
+		}
+		void root_die::forget_cu_ranges()
+		{
+			p_cu_ranges.reset();
+		}
+		iterator_df<compile_unit_die> root_die::cu_for_pc(Dwarf_Addr file_relative_addr)
+		{
+			opt<Dwarf_Off> found = get_cu_range_index().cu_for(file_relative_addr);
+			if (!found) return iterator_base::END;
+			return cu_pos(*found);
+		}
+
+		const static_data_index& root_die::get_static_data_index()
+		{
+			if (!p_static_data_index) p_static_data_index.reset(new static_data_index(*this));
+			return *p_static_data_index;
+		}
+		void root_die::forget_static_data_index()
+		{
+			p_static_data_index.reset();
+		}
+
+		void root_die::load_line_tables()
+		{
+			/* Only libdwarf-backed compile units have line number programs
+			 * that we decode; see compile_unit_die::get_line_table(). */
+			std::vector<iterator_df<compile_unit_die> > cus;
+			std::vector<Dwarf_Off> cu_offs;
+			auto cu_seq = children();
+			for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+			{
+				if (i_cu.tag_here() != DW_TAG_compile_unit) continue;
+				iterator_df<compile_unit_die> cu = i_cu.base();
+				if (cu->p_line_table) continue;
+				cus.push_back(cu);
+				cu_offs.push_back(cu.offset_here());
+			}
+			std::vector<std::shared_ptr<line_table> > tables(cus.size());
+			unsigned nworkers = index_worker_count();
+			if (nworkers > 1 && cus.size() > 1)
+			{
+				/* The tables hold only decoded rows, nothing pointing into
+				 * a worker's libdwarf, so the workers can go when done. */
+				std::vector<std::unique_ptr<WorkerDebug> > workers(nworkers);
+				parallel_for(cu_offs.size(), nworkers,
+					[this, &cu_offs, &tables, &workers](unsigned n, unsigned w) {
+						if (!workers[w]) workers[w].reset(new WorkerDebug(opened_fd));
+						tables[n] = std::make_shared<line_table>(workers[w]->raw_handle(), cu_offs[n]);
+					});
+			}
+			else for (unsigned n = 0; n < cus.size(); ++n)
+			{
+				tables[n] = std::make_shared<line_table>(cus[n]->d);
+			}
+			/* CU payloads are sticky, so the tables stay put. */
+			for (unsigned n = 0; n < cus.size(); ++n) cus[n]->p_line_table = tables[n];
+		}
+
+		const type_name_index& root_die::get_type_name_index()
+		{
+			if (!p_type_names) p_type_names.reset(new type_name_index(*this));
+			return *p_type_names;
+		}
+		void root_die::forget_type_names()
+		{
+			p_type_names.reset();
+		}
+
+		const symbol_index& root_die::get_symbol_index()
+		{
+			if (!p_symbols) p_symbols.reset(new symbol_index(*this));
+			return *p_symbols;
+		}
+		void root_die::forget_symbol_dies()
+		{
+			if (p_symbols) p_symbols->forget_dies();
+		}
+
+		const name_dictionary& root_die::get_name_dictionary()
+		{
+			if (!p_name_dictionary) p_name_dictionary.reset(new name_dictionary(*this));
+			return *p_name_dictionary;
+		}
+		void root_die::forget_name_dictionary()
+		{
+			p_name_dictionary.reset();
+		}
+
+		const demangled_name_index& root_die::get_demangled_name_index()
+		{
+			if (!p_demangled_names) p_demangled_names.reset(new demangled_name_index(*this));
+			return *p_demangled_names;
+		}
+		void root_die::forget_demangled_names()
+		{
+			p_demangled_names.reset();
+		}
+
+		void root_die::load_name_tables()
+		{
+			if (name_tables_loaded) return;
+			name_tables_loaded = true;
+			if (!dbg.handle) return;
+			char *name;
+			Dwarf_Off off;
+			/* .debug_pubnames, and with a recent libdwarf also .debug_names */
+			GlobalList globals(GlobalList::try_construct(dbg.raw_handle()));
+			for (auto i_g = globals.copied_list.begin(); i_g != globals.copied_list.end(); ++i_g)
+			{
+				if (dwarf_globname(i_g->get(), &name, &current_dwarf_error) != DW_DLV_OK) continue;
+				if (dwarf_global_die_offset(i_g->get(), &off, &current_dwarf_error) == DW_DLV_OK)
+				{
+					name_table_offsets.insert(make_pair(intern_name(name), off));
+				}
+				dwarf_dealloc(dbg.raw_handle(), name, DW_DLA_STRING);
+			}
+			/* .debug_pubtypes comes with its own deallocator, so no handle. */
+			Dwarf_Type *types;
+			Dwarf_Signed ntypes;
+			if (dwarf_get_pubtypes(dbg.raw_handle(), &types, &ntypes, &current_dwarf_error)
+				!= DW_DLV_OK) return;
+			for (Dwarf_Signed n = 0; n < ntypes; ++n)
+			{
+				if (dwarf_pubtypename(types[n], &name, &current_dwarf_error) != DW_DLV_OK) continue;
+				if (dwarf_pubtype_die_offset(types[n], &off, &current_dwarf_error) == DW_DLV_OK)
+				{
+					name_table_offsets.insert(make_pair(intern_name(name), off));
+				}
+				dwarf_dealloc(dbg.raw_handle(), name, DW_DLA_STRING);
+			}
+			dwarf_pubtypes_dealloc(dbg.raw_handle(), types, ntypes);
+
+			std::set<Dwarf_Off> cus_covered;
+			if (load_debug_names(cus_covered))
+			{
+				name_tables_complete = true;
+				auto cu_seq = children();
+				for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+				{
+					if (cus_covered.find(i_cu.offset_here()) == cus_covered.end())
+					{ name_tables_complete = false; break; }
+				}
+			}
+		}
+
+		/* The section's bytes, if it's there and we can read it in place. */
+		static pair<const unsigned char *, const unsigned char *>
+		section_bytes(::Elf *e, const char *wanted)
+		{
+			auto none = make_pair((const unsigned char *) nullptr, (const unsigned char *) nullptr);
+			size_t shstrndx;
+			if (!e || elf_getshdrstrndx(e, &shstrndx) != 0) return none;
+			for (Elf_Scn *scn = elf_nextscn(e, nullptr); scn; scn = elf_nextscn(e, scn))
+			{
+				GElf_Shdr shdr;
+				if (!gelf_getshdr(scn, &shdr) || (shdr.sh_flags & SHF_COMPRESSED)) continue;
+				const char *name = elf_strptr(e, shstrndx, shdr.sh_name);
+				if (!name || 0 != strcmp(name, wanted)) continue;
+				Elf_Data *data = elf_rawdata(scn, nullptr);
+				if (!data || !data->d_buf) return none;
+				const unsigned char *begin = static_cast<const unsigned char *>(data->d_buf);
+				return make_pair(begin, begin + data->d_size);
+			}
+			return none;
+		}
+
+		/* Reading .debug_names (DWARF 5 section 6.1.1) ourselves is simpler
+		 * than coping with the several versions of libdwarf's interface to it,
+		 * since we only want (name, DIE) pairs. We read it in host byte order,
+		 * so give up on a foreign-endian file, and on anything else we don't
+		 * understand; the caller then has to scan. Entries for DIEs with an
+		 * indexed parent can't be CU children, so we skip them. Returns true
+		 * if every unit of the section made sense, adding the CUs it covers. */
+		bool root_die::load_debug_names(std::set<Dwarf_Off>& cus_covered)
+		{
+			::Elf *e = get_elf();
+			GElf_Ehdr ehdr;
+			if (!e || !gelf_getehdr(e, &ehdr)) return false;
+			if (ehdr.e_ident[EI_DATA] != (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+				? ELFDATA2LSB : ELFDATA2MSB)) return false;
+			auto names = section_bytes(e, ".debug_names");
+			auto strs = section_bytes(e, ".debug_str");
+			if (!names.first || !strs.first) return false;
+
+			const unsigned char *pos = names.first;
+			const unsigned char *limit = names.second;
+			auto fixed = [&pos, &limit](unsigned size, Dwarf_Unsigned& out) -> bool {
+				if ((Dwarf_Unsigned)(limit - pos) < size) return false;
+				uint8_t u1; uint16_t u2; uint32_t u4; uint64_t u8;
+				switch (size)
+				{
+					case 1: std::memcpy(&u1, pos, 1); out = u1; break;
+					case 2: std::memcpy(&u2, pos, 2); out = u2; break;
+					case 4: std::memcpy(&u4, pos, 4); out = u4; break;
+					case 8: std::memcpy(&u8, pos, 8); out = u8; break;
+					default: return false;
+				}
+				pos += size;
+				return true;
+			};
+			auto leb = [&pos, &limit](Dwarf_Unsigned& out) -> bool {
+				out = 0;
+				unsigned shift = 0;
+				unsigned char b;
+				do
+				{
+					if (pos == limit || shift >= 64) return false;
+					b = *pos++;
+					out |= static_cast<Dwarf_Unsigned>(b & 0x7f) << shift;
+					shift += 7;
+				} while (b & 0x80);
+				return true;
+			};
+			auto value = [&fixed, &leb](Dwarf_Unsigned form, Dwarf_Unsigned& out) -> bool {
+				switch (form)
+				{
+					case DW_FORM_flag_present: out = 1; return true;
+					case DW_FORM_data1: case DW_FORM_ref1: return fixed(1, out);
+					case DW_FORM_data2: case DW_FORM_ref2: return fixed(2, out);
+					case DW_FORM_data4: case DW_FORM_ref4: return fixed(4, out);
+					case DW_FORM_data8: case DW_FORM_ref8: case DW_FORM_ref_sig8: return fixed(8, out);
+					case DW_FORM_udata: case DW_FORM_ref_udata: case DW_FORM_sdata: return leb(out);
+					default: return false;
+				}
+			};
+			struct abbrev
 			{
-				if (i_child.name_here() && *i_child.name_here() == name)
+				vector<pair<Dwarf_Unsigned, Dwarf_Unsigned> > idx_forms;
+			};
+
+			while (pos < names.second)
+			{
+				/* The unit header. */
+				Dwarf_Unsigned unit_length, version, padding, cu_count, local_tu_count,
+					foreign_tu_count, bucket_count, name_count, abbrev_size, aug_size;
+				unsigned offset_size = 4;
+				limit = names.second;
+				if (!fixed(4, unit_length)) return false;
+				if (unit_length == 0xffffffffu)
+				{
+					if (!fixed(8, unit_length)) return false;
+					offset_size = 8;
+				}
+				if (unit_length > (Dwarf_Unsigned)(names.second - pos)) return false;
+				limit = pos + unit_length;
+				const unsigned char *unit_end = limit;
+				if (!fixed(2, version) || version != 5 || !fixed(2, padding)
+					|| !fixed(4, cu_count) || !fixed(4, local_tu_count)
+					|| !fixed(4, foreign_tu_count) || !fixed(4, bucket_count)
+					|| !fixed(4, name_count) || !fixed(4, abbrev_size)
+					|| !fixed(4, aug_size)) return false;
+				aug_size = (aug_size + 3) & ~(Dwarf_Unsigned) 3;
+				if (aug_size > (Dwarf_Unsigned)(limit - pos)) return false;
+				pos += aug_size;
+
+				/* The CUs, as offsets of their headers in .debug_info. */
+				vector<Dwarf_Off> cu_headers;
+				for (Dwarf_Unsigned n = 0; n < cu_count; ++n)
+				{
+					Dwarf_Unsigned off;
+					if (!fixed(offset_size, off)) return false;
+					cu_headers.push_back(off);
+					Dwarf_Off cu_die_off;
+					if (dwarf_get_cu_die_offset_given_cu_header_offset(dbg.raw_handle(),
+						off, &cu_die_off, &current_dwarf_error) != DW_DLV_OK) return false;
+					cus_covered.insert(cu_die_off);
+				}
+				/* Skip the type unit lists and the hash table. */
+				Dwarf_Unsigned skip = local_tu_count * offset_size + foreign_tu_count * 8
+					+ bucket_count * 4 + (bucket_count ? name_count * 4 : 0);
+				if (skip > (Dwarf_Unsigned)(limit - pos)) return false;
+				pos += skip;
+				/* The name table: string offsets, then entry offsets. */
+				if (name_count * 2 * offset_size > (Dwarf_Unsigned)(limit - pos)) return false;
+				const unsigned char *str_offsets = pos;
+				const unsigned char *entry_offsets = pos + name_count * offset_size;
+				pos += name_count * 2 * offset_size;
+				/* The abbreviations. */
+				if (abbrev_size > (Dwarf_Unsigned)(limit - pos)) return false;
+				const unsigned char *entry_pool = pos + abbrev_size;
+				limit = entry_pool;
+				std::map<Dwarf_Unsigned, abbrev> abbrevs;
+				while (true)
+				{
+					Dwarf_Unsigned code, tag;
+					if (!leb(code)) return false;
+					if (code == 0) break;
+					if (!leb(tag)) return false;
+					abbrev& a = abbrevs[code];
+					while (true)
+					{
+						Dwarf_Unsigned idx, form;
+						if (!leb(idx) || !leb(form)) return false;
+						if (idx == 0 && form == 0) break;
+						a.idx_forms.push_back(make_pair(idx, form));
+					}
+				}
+				/* The entries for each name. */
+				limit = unit_end;
+				for (Dwarf_Unsigned n = 0; n < name_count; ++n)
 				{
-					return std::move(i_child);
+					Dwarf_Unsigned str_off, entry_off;
+					pos = str_offsets + n * offset_size;
+					if (!fixed(offset_size, str_off)) return false;
+					pos = entry_offsets + n * offset_size;
+					if (!fixed(offset_size, entry_off)) return false;
+					if (str_off >= (Dwarf_Unsigned)(strs.second - strs.first)
+						|| entry_off >= (Dwarf_Unsigned)(unit_end - entry_pool)) return false;
+					const char *str = reinterpret_cast<const char *>(strs.first + str_off);
+					if (!memchr(str, '\0', strs.second - strs.first - str_off)) return false;
+					name_atom atom = NO_NAME_ATOM;
+					pos = entry_pool + entry_off;
+					while (true)
+					{
+						Dwarf_Unsigned code;
+						if (!leb(code)) return false;
+						if (code == 0) break;
+						auto found = abbrevs.find(code);
+						if (found == abbrevs.end()) return false;
+						opt<Dwarf_Unsigned> cu_index, die_offset;
+						bool in_type_unit = false, has_indexed_parent = false;
+						for (auto i_f = found->second.idx_forms.begin();
+							i_f != found->second.idx_forms.end(); ++i_f)
+						{
+							Dwarf_Unsigned v;
+							if (!value(i_f->second, v)) return false;
+							switch (i_f->first)
+							{
+								case DW_IDX_compile_unit: cu_index = v; break;
+								case DW_IDX_type_unit: in_type_unit = true; break;
+								case DW_IDX_die_offset: die_offset = v; break;
+								case DW_IDX_parent:
+									has_indexed_parent = (i_f->second != DW_FORM_flag_present);
+									break;
+								default: break;
+							}
+						}
+						if (in_type_unit || has_indexed_parent || !die_offset) continue;
+						/* With only one CU, the index may leave it implicit. */
+						if (!cu_index && cu_count == 1) cu_index = 0;
+						if (!cu_index || *cu_index >= cu_headers.size()) continue;
+						if (atom == NO_NAME_ATOM) atom = intern_name(str);
+						// DW_IDX_die_offset is relative to the unit header, like a ref4
+						name_table_offsets.insert(make_pair(atom, cu_headers[*cu_index] + *die_offset));
+					}
 				}
+				pos = unit_end;
+				limit = names.second;
 			}
-			return iterator_base::END;
+			return true;
 		}
 		
+		bool root_die::name_tables_answer_misses()
+		{
+			return true;
+		}
+
 		iterator_base
 		root_die::find_visible_grandchild_named(const string& name)
 		{
@@ -657,6 +1302,15 @@ namespace dwarf
 			sticky_dies.insert(make_pair(o, p));
 			assert(live_dies.find(o) != live_dies.end());
 			parent_of.insert(make_pair(o, parent.offset_here()));
+			forget_child_names(parent.offset_here());
+			forget_qualified_names();
+			forget_address_index();
+			forget_cu_ranges();
+			forget_static_data_index();
+			forget_type_names();
+			forget_symbol_dies();
+			forget_name_dictionary();
+			forget_demangled_names();
 			auto found = find(o);
 			assert(found);
 			return found;
@@ -672,6 +1326,37 @@ namespace dwarf
 		 * BUT
 		 * core::factory_for(dwarf_current_def::inst).make_payload(handle) WOULD work. So
 		 * it's a toss-up. Go with the latter. */
+		constexpr root_die::name_atom root_die::NO_NAME_ATOM;
+		constexpr unsigned root_die::MIN_HASHED_CHILDREN;
+		
+		root_die::name_atom root_die::intern_name(name_ref n)
+		{
+			if (n.empty()) return NO_NAME_ATOM;
+			auto found = name_atoms.find(n);
+			if (found != name_atoms.end()) return found->second;
+			interned_names.push_back(string(n.begin(), n.end()));
+			name_atom atom = interned_names.size();
+			name_atoms.insert(make_pair(name_ref(interned_names.back()), atom));
+			return atom;
+		}
+		
+		root_die::name_atom root_die::find_name_atom(name_ref n) const
+		{
+			auto found = name_atoms.find(n);
+			return (found != name_atoms.end()) ? found->second : NO_NAME_ATOM;
+		}
+		
+		name_ref root_die::name_for_atom(name_atom a) const
+		{
+			if (a == NO_NAME_ATOM) return name_ref();
+			return name_ref(interned_names.at(a - 1));
+		}
+		
+		root_die::name_atom root_die::name_atom_here(const iterator_base& i)
+		{
+			return intern_name(i.name_ref_here());
+		}
+		
 		bool root_die::is_sticky(const abstract_die& d)
 		{
 			/* This sets the default policy for stickiness: compile unit DIEs
@@ -684,29 +1369,212 @@ namespace dwarf
 			return d.get_tag() == DW_TAG_compile_unit;
 		}
 		
+		bool root_die::caches_found_attrs(const basic_die& d)
+		{
+			/* By default, cache for libdwarf-backed DIEs, whose attributes can't 
+			 * change under us. In-memory DIEs can gain attributes at any time, 
+			 * so we'd have to invalidate. Note that a cached view can still go
+			 * stale if it includes an in-memory DIE's attributes via a reference; 
+			 * subclasses that build such DIEs should override this. */
+			return d.d.handle != nullptr;
+		}
+		
+		root_die::cu_offset_index&
+		root_die::offset_index_for_cu(Dwarf_Off cu_off)
+		{
+			auto found = cu_offset_indexes.find(cu_off);
+			if (found != cu_offset_indexes.end()) return found->second;
+			cu_offset_index& idx = cu_offset_indexes[cu_off];
+			index_cu(dbg.handle.get(), cu_off, idx, nullptr);
+			return idx;
+		}
+		
 		void
-		root_die::get_referential_structure(
-			unordered_map<Dwarf_Off, Dwarf_Off>& parent_of,
-			map<pair<Dwarf_Off, Dwarf_Half>, Dwarf_Off>& refers_to) const
+		root_die::index_cu(Dwarf_Debug raw_dbg, Dwarf_Off cu_off,
+			cu_offset_index& idx, ref_list *p_refs)
+		{
+			/* A CU that libdwarf doesn't know about, e.g. our synthetic one,
+			 * just gets an empty index. */
+			Dwarf_Die raw_cu;
+			if (!raw_dbg || dwarf_offdie(raw_dbg, cu_off, &raw_cu, &current_dwarf_error) != DW_DLV_OK) return;
+			index_cu_subtree(raw_dbg, Die::handle_type(raw_cu, Die::deleter(raw_dbg)),
+				0UL, 1, idx, p_refs);
+		}
+		
+		void
+		root_die::index_cu_subtree(Dwarf_Debug raw_dbg, Die::handle_type first,
+			Dwarf_Off parent_off, unsigned short depth, cu_offset_index& idx, ref_list *p_refs)
+		{
+			Die::handle_type cur = std::move(first);
+			while (cur)
+			{
+				Dwarf_Off off;
+				int ret = dwarf_dieoffset(cur.get(), &off, &current_dwarf_error);
+				if (ret != DW_DLV_OK) throw Error(current_dwarf_error, 0);
+				idx.offsets.push_back(off);
+				idx.parents.push_back(parent_off);
+				idx.depths.push_back(depth);
+				
+				if (p_refs)
+				{
+					Dwarf_Attribute *attrs;
+					Dwarf_Signed len;
+					ret = dwarf_attrlist(cur.get(), &attrs, &len, &current_dwarf_error);
+					if (ret == DW_DLV_ERROR) throw Error(current_dwarf_error, 0);
+					for (Dwarf_Signed i = 0; ret == DW_DLV_OK && i < len; ++i)
+					{
+						Dwarf_Half attr;
+						Dwarf_Half form;
+						Dwarf_Off target;
+						if (dwarf_whatattr(attrs[i], &attr, &current_dwarf_error) == DW_DLV_OK
+							&& dwarf_whatform(attrs[i], &form, &current_dwarf_error) == DW_DLV_OK
+							&& (form == DW_FORM_ref1 || form == DW_FORM_ref2
+								|| form == DW_FORM_ref4 || form == DW_FORM_ref8
+								|| form == DW_FORM_ref_udata || form == DW_FORM_ref_addr)
+							&& dwarf_global_formref(attrs[i], &target, &current_dwarf_error) == DW_DLV_OK)
+						{
+							p_refs->push_back(make_pair(make_pair(off, attr), target));
+						}
+						dwarf_dealloc(raw_dbg, attrs[i], DW_DLA_ATTR);
+					}
+					if (ret == DW_DLV_OK) dwarf_dealloc(raw_dbg, attrs, DW_DLA_LIST);
+				}
+				
+				Dwarf_Die raw_next;
+				if (dwarf_child(cur.get(), &raw_next, &current_dwarf_error) == DW_DLV_OK)
+				{
+					index_cu_subtree(raw_dbg, Die::handle_type(raw_next, Die::deleter(raw_dbg)),
+						off, depth + 1, idx, p_refs);
+				}
+				/* The CU DIE has no siblings that concern us. */
+				if (depth == 1) break;
+				if (dwarf_siblingof(raw_dbg, cur.get(), &raw_next, &current_dwarf_error) == DW_DLV_OK)
+				{
+					cur = Die::handle_type(raw_next, Die::deleter(raw_dbg));
+				}
+				else cur = Die::handle_type(nullptr, Die::deleter(nullptr));
+			}
+		}
+		
+		opt<pair<unsigned short, Dwarf_Off> >
+		root_die::locate_in_cu(Dwarf_Off off, Dwarf_Off cu_off)
+		{
+			const cu_offset_index& idx = offset_index_for_cu(cu_off);
+			auto found = std::lower_bound(idx.offsets.begin(), idx.offsets.end(), off);
+			if (found == idx.offsets.end() || *found != off)
+			{
+				return opt<pair<unsigned short, Dwarf_Off> >();
+			}
+			unsigned n = found - idx.offsets.begin();
+			return make_pair(idx.depths[n], idx.parents[n]);
+		}
+		
+		opt<pair<unsigned short, Dwarf_Off> >
+		root_die::locate(Dwarf_Off off)
 		{
-			/* We walk the whole tree depth-first. 
-			 * If we see any attributes that are references, we follow them. 
-			 * Then we return our maps. */
-			for (auto i = begin(); i != end(); ++i)
+			auto h = Die::try_construct(*this, off);
+			Dwarf_Off cu_off;
+			if (!h || dwarf_CU_dieoffset_given_die(h.get(), &cu_off, &current_dwarf_error)
+				!= DW_DLV_OK) return opt<pair<unsigned short, Dwarf_Off> >();
+			/* libdwarf will happily decode from the middle of a DIE, so
+			 * check that the CU's walk actually starts one here. */
+			return locate_in_cu(off, cu_off);
+		}
+		
+		void
+		root_die::index_references_in_cu(Dwarf_Off cu_off)
+		{
+			cu_offset_index& idx = cu_offset_indexes[cu_off];
+			if (idx.refs_indexed) return;
+			/* Redo the structure while we're at it; it's the same walk. */
+			idx = cu_offset_index();
+			ref_list refs;
+			index_cu(dbg.handle.get(), cu_off, idx, &refs);
+			for (auto i_ref = refs.begin(); i_ref != refs.end(); ++i_ref)
+			{
+				refers_to[i_ref->first] = i_ref->second;
+			}
+			idx.refs_indexed = true;
+		}
+		
+		void
+		root_die::index_all_references()
+		{
+			/* References out of libdwarf-backed DIEs we can index in bulk,
+			 * one CU at a time. */
+			std::vector<Dwarf_Off> cu_offs;
+			auto cus = children();
+			for (auto i_cu = std::move(cus.first); i_cu != cus.second; ++i_cu)
+			{
+				auto found = cu_offset_indexes.find(i_cu.offset_here());
+				if (found == cu_offset_indexes.end() || !found->second.refs_indexed)
+				{
+					cu_offs.push_back(i_cu.offset_here());
+				}
+			}
+			unsigned nworkers = index_worker_count();
+			if (nworkers > 1 && cu_offs.size() > 1)
+			{
+				/* Each worker walks whole CUs on its own handle. Merging into
+				 * the root's maps is left to us, on this thread. */
+				std::vector<cu_offset_index> idxs(cu_offs.size());
+				std::vector<ref_list> refs(cu_offs.size());
+				std::vector<std::unique_ptr<WorkerDebug> > workers(nworkers);
+				parallel_for(cu_offs.size(), nworkers,
+					[this, &cu_offs, &idxs, &refs, &workers](unsigned n, unsigned w) {
+						if (!workers[w]) workers[w].reset(new WorkerDebug(opened_fd));
+						index_cu(workers[w]->raw_handle(), cu_offs[n], idxs[n], &refs[n]);
+					});
+				for (unsigned n = 0; n < cu_offs.size(); ++n)
+				{
+					for (auto i_ref = refs[n].begin(); i_ref != refs[n].end(); ++i_ref)
+					{
+						refers_to[i_ref->first] = i_ref->second;
+					}
+					idxs[n].refs_indexed = true;
+					cu_offset_indexes[cu_offs[n]] = std::move(idxs[n]);
+				}
+			}
+			else for (auto i_off = cu_offs.begin(); i_off != cu_offs.end(); ++i_off)
+			{
+				index_references_in_cu(*i_off);
+			}
+			/* Any in-memory DIEs we have to do the old way: walk the whole
+			 * tree depth-first, following any attributes that are references. */
+			bool any_in_memory = has_in_memory_dies();
+			for (auto i = begin(); any_in_memory && i != end(); ++i)
 			{
+				if (dynamic_cast<Die *>(&i.get_handle())) continue; // done above
 				encap::attribute_map attrs = i.copy_attrs(); //(i.attrs_here(), i.get_handle(), *this);
 				for (auto i_a = attrs.begin(); i_a != attrs.end(); ++i_a)
 				{
 					if (i_a->second.get_form() == encap::attribute_value::REF)
 					{
-						auto found = const_cast<root_die *>(this)->find(
-							i_a->second.get_ref().off, 
+						auto found = find(i_a->second.get_ref().off,
 							make_pair(i.offset_here(), i_a->first));
 					}
 				}
 			}
-			
+		}
+
+		void
+		root_die::get_referential_structure(
+			unordered_map<Dwarf_Off, Dwarf_Off>& parent_of,
+			map<pair<Dwarf_Off, Dwarf_Half>, Dwarf_Off>& refers_to) const
+		{
+			const_cast<root_die *>(this)->index_all_references();
 			parent_of = this->parent_of;
+			/* The bulk walk records libdwarf-backed DIEs' parents only in the
+			 * per-CU offset indexes, so merge those in too. Anything already
+			 * in parent_of (e.g. an in-memory DIE) takes precedence. */
+			for (auto i_cu = cu_offset_indexes.begin(); i_cu != cu_offset_indexes.end(); ++i_cu)
+			{
+				const cu_offset_index& idx = i_cu->second;
+				for (unsigned n = 0; n < idx.offsets.size(); ++n)
+				{
+					parent_of.insert(make_pair(idx.offsets[n], idx.parents[n]));
+				}
+			}
 			refers_to = this->refers_to;
 		}
 		
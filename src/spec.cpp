@@ -26,7 +26,10 @@ namespace dwarf
 		int explicit_interp(abstract_def& def, int attr, const int *attr_possible_classes,
 			int form, const int *form_possible_classes)
 		{
-			vector<int> possibles;
+			/* There are only a dozen or so classes, so the intersection can
+			 * never be bigger than that; keep it on the stack. */
+			int possibles[interp::exprloc + 1];
+			unsigned npossibles = 0;
 
 			// null pointer means the empty list
 			if (attr_possible_classes == 0
@@ -49,13 +52,13 @@ namespace dwarf
 			&& (form_possible_classes != 0 && form_possible_classes[0] != interp::EOL))
 			{
 				if (form_possible_classes[1] == interp::EOL) //return form_possible_classes[0];
-					possibles.push_back(form_possible_classes[0]);
+					possibles[npossibles++] = form_possible_classes[0];
 			}
 			else if ((attr_possible_classes != 0 && attr_possible_classes[0] != interp::EOL)
 			&& (form_possible_classes == 0 || form_possible_classes[0] == interp::EOL))
 			{
 				if (attr_possible_classes[1] == interp::EOL) //return attr_possible_classes[0];
-					possibles.push_back(attr_possible_classes[0] & ~interp::FLAGS);
+					possibles[npossibles++] = attr_possible_classes[0] & ~interp::FLAGS;
 			}
 			else
 			{
@@ -69,15 +72,19 @@ namespace dwarf
 					for (const int *p_form_cls = form_possible_classes;
 						p_form_cls != 0 && *p_form_cls != interp::EOL; ++p_form_cls)
 					{
-						if (*p_form_cls == (*p_attr_cls & ~interp::FLAGS)) possibles.push_back(*p_form_cls);
+						if (*p_form_cls == (*p_attr_cls & ~interp::FLAGS)
+							&& npossibles < sizeof possibles / sizeof possibles[0])
+						{
+							possibles[npossibles++] = *p_form_cls;
+						}
 					}
 				}
 			}
 
-			switch (possibles.size())
+			switch (npossibles)
 			{
 				case 1: // this is the good case
-					return *(possibles.begin());
+					return possibles[0];
 				fail:
 				case 0:
 					// if we got here, there's an error 
@@ -88,15 +95,28 @@ namespace dwarf
 					// this means >1
 					debug() << "Warning: multiple possible interpretations for attr "
 						 << def.attr_lookup(attr) << ", value form " << def.form_lookup(form) << ": { "; 
-					for (auto i_poss = possibles.begin(); i_poss != possibles.end(); ++i_poss)
+					for (unsigned i = 0; i < npossibles; ++i)
 					{
-						if (i_poss != possibles.begin()) debug() << ", ";
-						debug() << *i_poss;
+						if (i != 0) debug() << ", ";
+						debug() << possibles[i];
 					}
 					debug() << " }" << endl;
-					return *(possibles.begin());
+					return possibles[0];
 			}
 		}
+
+		unsigned char *abstract_def::make_interp_table() const
+		{
+			/* Every entry starts out as "not yet", and interp_for() fills
+			 * entries in as pairs are encountered. Filling eagerly would mean
+			 * calling get_interp() on every nonsensical pair, and each of
+			 * those prints a warning. */
+			const unsigned size = (INTERP_TABLE_STD_ATTRS + INTERP_TABLE_USER_ATTRS)
+				* INTERP_TABLE_FORMS;
+			interp_table.reset(new unsigned char[size]);
+			std::fill(interp_table.get(), interp_table.get() + size, INTERP_NOT_YET);
+			return interp_table.get();
+		}
 		
 		typedef std::pair<const char *, int> forward_name_mapping_t;
 		typedef std::pair<int, const char *> inverse_name_mapping_t;
@@ -0,0 +1,104 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * symbolize.cpp: many addresses to functions, inlined calls and lines.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/dies.hpp"
+#include "dwarfpp/dies-inl.hpp"
+#include "dwarfpp/address-index.hpp"
+#include "dwarfpp/symbolize.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		batch_symbolization::batch_symbolization(root_die& r, const vector<Dwarf_Addr>& addrs)
+		 : m_results(addrs.size()), ndistinct(0)
+		{
+			const address_index& idx = r.get_address_index();
+			const inline_frame_index& inlines = r.get_inline_frame_index();
+			const cu_range_index& cus = r.get_cu_range_index();
+
+			vector<unsigned> order(addrs.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(),
+				[&addrs](unsigned n1, unsigned n2) { return addrs[n1] < addrs[n2]; });
+
+			/* What holds for addresses below each "until". Since we go in
+			 * order, an address below it is covered by the same answer. */
+			Dwarf_Addr seg_until = 0, line_until = 0;
+			address_index::node_id node = address_index::NO_NODE;
+			result cur = { 0, 0, 0, 0, 0, opt<line_table::row>() };
+			Dwarf_Off line_cu = 0;
+			const line_table *lines = nullptr;
+			/* Where in m_frames each innermost node's stack went. A node can
+			 * own several segments, e.g. either side of a nested inlined call. */
+			std::unordered_map<address_index::node_id, pair<unsigned, unsigned> > stack_for_node;
+
+			for (auto i_o = order.begin(); i_o != order.end(); )
+			{
+				Dwarf_Addr addr = addrs[*i_o];
+				++ndistinct;
+				if (ndistinct == 1 || addr >= seg_until)
+				{
+					node = idx.innermost(addr, &seg_until);
+					auto found = stack_for_node.find(node);
+					if (found == stack_for_node.end())
+					{
+						vector<inline_frame_index::frame> stack = inlines.stack_from(node);
+						found = stack_for_node.insert(make_pair(node,
+							make_pair((unsigned) m_frames.size(), (unsigned) stack.size()))).first;
+						m_frames.insert(m_frames.end(), stack.begin(), stack.end());
+					}
+					cur.first_frame = found->second.first;
+					cur.nframes = found->second.second;
+					const inline_frame_index::frame *outermost = cur.nframes == 0 ? nullptr
+						: &m_frames[cur.first_frame + cur.nframes - 1];
+					cur.function = outermost ? outermost->die : 0;
+					cur.cu = 0;
+					if (outermost) cur.cu = outermost->cu;
+					else for (address_index::node_id n = node; n != address_index::NO_NODE;
+						n = idx.get(n).parent)
+					{
+						Dwarf_Half tag = idx.get(n).tag;
+						if (tag == DW_TAG_compile_unit || tag == DW_TAG_partial_unit)
+						{ cur.cu = idx.get(n).off; break; }
+					}
+				}
+				/* Outside anything ranged, the aranges might still know. */
+				if (node == address_index::NO_NODE)
+				{
+					opt<Dwarf_Off> found_cu = cus.cu_for(addr);
+					cur.cu = found_cu ? *found_cu : 0;
+				}
+				if (cur.cu != line_cu)
+				{
+					line_cu = cur.cu;
+					/* Only compile units have a line table of their own;
+					 * a partial unit's payload isn't a compile_unit_die. */
+					lines = (line_cu && r.pos(line_cu, 1).tag_here() == DW_TAG_compile_unit)
+						? &r.cu_pos(line_cu)->get_line_table() : nullptr;
+					line_until = 0;
+				}
+				if (!lines) cur.line = opt<line_table::row>();
+				else if (addr >= line_until) cur.line = lines->find(addr, &line_until);
+				cur.addr = addr;
+
+				for (; i_o != order.end() && addrs[*i_o] == addr; ++i_o) m_results[*i_o] = cur;
+			}
+		}
+	}
+}
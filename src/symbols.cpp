@@ -0,0 +1,237 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * symbols.cpp: the ELF symbol tables, joined with the DIEs.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include <gelf.h>
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/dies.hpp"
+#include "dwarfpp/dies-inl.hpp"
+#include "dwarfpp/address-index.hpp"
+#include "dwarfpp/symbols.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		/* The name a symbol for this DIE would have, if any. */
+		static opt<string> symbol_name_here(const iterator_base& i)
+		{
+			Dwarf_Half tag = i.tag_here();
+			if (tag != DW_TAG_subprogram && tag != DW_TAG_variable) return opt<string>();
+			if (i.has_attr_here(DW_AT_linkage_name))
+			{
+				return i.attr(DW_AT_linkage_name).get_string();
+			}
+			if (i.has_attr_here(DW_AT_MIPS_linkage_name))
+			{
+				return i.attr(DW_AT_MIPS_linkage_name).get_string();
+			}
+			if (i.has_attr_here(DW_AT_external) && i.attr(DW_AT_external).get_flag())
+			{
+				name_ref name = i.name_ref_here();
+				if (!name.empty()) return name.to_string();
+			}
+			return opt<string>();
+		}
+
+		static Dwarf_Addr end_of(const symbol_index::symbol& sym)
+		{
+			return sym.value + (sym.size ? sym.size : 1);
+		}
+
+		symbol_index::symbol_index(root_die& r) : r(r), linkage_names_indexed(false)
+		{
+			::Elf *e = r.get_elf();
+			if (e)
+			{
+				read_symtab(e, SHT_SYMTAB);
+				read_symtab(e, SHT_DYNSYM);
+			}
+			for (sym_id s = 0; s < symbols.size(); ++s)
+			{
+				const symbol& sym = symbols[s];
+				if (sym.shndx == SHN_UNDEF || sym.shndx == SHN_ABS
+					|| sym.shndx == SHN_COMMON || sym.type == STT_TLS) continue;
+				by_addr.push_back(s);
+			}
+			std::sort(by_addr.begin(), by_addr.end(),
+				[this](sym_id s1, sym_id s2) {
+					return symbols[s1].value < symbols[s2].value
+						|| (symbols[s1].value == symbols[s2].value && s1 < s2);
+				});
+			Dwarf_Addr running = 0;
+			for (auto i_s = by_addr.begin(); i_s != by_addr.end(); ++i_s)
+			{
+				running = std::max(running, end_of(symbols[*i_s]));
+				max_end.push_back(running);
+			}
+		}
+
+		void symbol_index::read_symtab(::Elf *e, unsigned sh_type)
+		{
+			for (Elf_Scn *scn = elf_nextscn(e, nullptr); scn; scn = elf_nextscn(e, scn))
+			{
+				GElf_Shdr shdr;
+				if (!gelf_getshdr(scn, &shdr) || shdr.sh_type != sh_type
+					|| shdr.sh_entsize == 0) continue;
+				Elf_Data *data = elf_getdata(scn, nullptr);
+				if (!data) continue;
+				unsigned nsyms = shdr.sh_size / shdr.sh_entsize;
+				for (unsigned n = 1; n < nsyms; ++n) // 0 is the null symbol
+				{
+					GElf_Sym sym;
+					if (!gelf_getsym(data, n, &sym)) continue;
+					unsigned char type = GELF_ST_TYPE(sym.st_info);
+					if (type == STT_SECTION || type == STT_FILE) continue;
+					const char *name = elf_strptr(e, shdr.sh_link, sym.st_name);
+					if (!name || !*name) continue;
+					if (sh_type == SHT_DYNSYM)
+					{
+						/* Most of .dynsym is also in .symtab. */
+						auto found = by_name.equal_range(name);
+						bool dup = false;
+						for (auto i_f = found.first; i_f != found.second; ++i_f)
+						{
+							if (symbols[i_f->second].value == sym.st_value) { dup = true; break; }
+						}
+						if (dup) continue;
+					}
+					symbol s = { name, sym.st_value, sym.st_size, type,
+						static_cast<unsigned char>(GELF_ST_BIND(sym.st_info)),
+						sym.st_shndx, sh_type == SHT_DYNSYM };
+					by_name.insert(make_pair(s.name, symbols.size()));
+					symbols.push_back(std::move(s));
+				}
+			}
+		}
+
+		void symbol_index::forget_dies()
+		{
+			die_by_linkage_name.clear();
+			linkage_names_indexed = false;
+		}
+
+		void symbol_index::index_linkage_names() const
+		{
+			if (linkage_names_indexed) return;
+			for (auto i = r.begin(); i != r.end(); ++i)
+			{
+				opt<string> name = symbol_name_here(i);
+				if (!name) continue;
+				auto found = die_by_linkage_name.find(*name);
+				if (found == die_by_linkage_name.end())
+				{
+					die_by_linkage_name.insert(make_pair(*name, i.offset_here()));
+				}
+				/* Prefer a definition over, say, a declaration in a class. */
+				else if (r.pos(found->second).is_declaration_here() && !i.is_declaration_here())
+				{
+					found->second = i.offset_here();
+				}
+			}
+			linkage_names_indexed = true;
+		}
+
+		vector<symbol_index::sym_id> symbol_index::find_all(const string& name) const
+		{
+			vector<sym_id> out;
+			auto found = by_name.equal_range(name);
+			for (auto i_f = found.first; i_f != found.second; ++i_f) out.push_back(i_f->second);
+			std::sort(out.begin(), out.end());
+			return out;
+		}
+
+		opt<symbol_index::sym_id> symbol_index::find(const string& name) const
+		{
+			opt<sym_id> best;
+			auto rank = [](unsigned char bind) {
+				return bind == STB_GLOBAL ? 0 : bind == STB_WEAK ? 1 : 2;
+			};
+			vector<sym_id> all = find_all(name);
+			for (auto i_s = all.begin(); i_s != all.end(); ++i_s)
+			{
+				if (symbols[*i_s].shndx == SHN_UNDEF) continue;
+				if (!best || rank(symbols[*i_s].bind) < rank(symbols[*best].bind)) best = *i_s;
+			}
+			return best;
+		}
+
+		opt<symbol_index::sym_id> symbol_index::covering(Dwarf_Addr addr) const
+		{
+			unsigned k = std::upper_bound(by_addr.begin(), by_addr.end(), addr,
+				[this](Dwarf_Addr a, sym_id s) { return a < symbols[s].value; }) - by_addr.begin();
+			opt<sym_id> best;
+			while (k > 0 && max_end[k - 1] > addr)
+			{
+				--k;
+				const symbol& sym = symbols[by_addr[k]];
+				if (best && sym.value != symbols[*best].value) break;
+				if (end_of(sym) <= addr) continue;
+				if (!best || (symbols[*best].size == 0 && sym.size != 0)) best = by_addr[k];
+			}
+			return best;
+		}
+
+		iterator_base symbol_index::die_for(sym_id s) const
+		{
+			const symbol& sym = symbols.at(s);
+			index_linkage_names();
+			auto found = die_by_linkage_name.find(sym.name);
+			if (found != die_by_linkage_name.end()) return r.pos(found->second);
+			if (sym.shndx == SHN_UNDEF) return iterator_base::END;
+			if (sym.type == STT_FUNC)
+			{
+				const address_index& idx = r.get_address_index();
+				address_index::node_id n = idx.enclosing(sym.value, DW_TAG_subprogram);
+				if (n != address_index::NO_NODE)
+				{
+					/* Not just any subprogram covering the address, e.g. the
+					 * one a local label or a .cold part sits in. */
+					iterator_base i = r.pos(idx.get(n).off);
+					if (i.has_attr_here(DW_AT_low_pc)
+						&& i.attr(DW_AT_low_pc).get_address().addr == sym.value) return i;
+				}
+			}
+			else if (sym.type == STT_OBJECT)
+			{
+				const static_data_index::entry *e = r.get_static_data_index().find(sym.value);
+				if (e && e->lo == sym.value) return r.pos(e->var);
+			}
+			return iterator_base::END;
+		}
+
+		opt<symbol_index::sym_id> symbol_index::symbol_for(const iterator_base& i) const
+		{
+			opt<string> name = symbol_name_here(i);
+			if (!name) return opt<sym_id>();
+			return find(*name);
+		}
+
+		with_static_location_die::sym_resolver_t symbol_index::resolver() const
+		{
+			/* Go through the root each time, rather than capturing this
+			 * index, which the root builds only when first asked. */
+			root_die& r = this->r;
+			return [&r](const string& name, void *) {
+				const symbol_index& idx = r.get_symbol_index();
+				opt<sym_id> found = idx.find(name);
+				if (!found) throw lib::No_entry();
+				with_static_location_die::sym_binding_t binding
+				 = { idx.get(*found).value, idx.get(*found).size };
+				return binding;
+			};
+		}
+	}
+}
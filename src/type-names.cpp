@@ -0,0 +1,131 @@
+/* dwarfpp: C++ binding for a useful subset of libdwarf, plus extra goodies.
+ *
+ * type-names.cpp: named types across all CUs, by qualified name and tag.
+ *
+ * Copyright (c) 2008--17, Stephen Kell. For licensing information, see the
+ * LICENSE file in the root of the libdwarfpp tree.
+ */
+
+#include "dwarfpp/root.hpp"
+#include "dwarfpp/root-inl.hpp"
+#include "dwarfpp/iter.hpp"
+#include "dwarfpp/iter-inl.hpp"
+#include "dwarfpp/type-names.hpp"
+
+#include <algorithm>
+
+namespace dwarf
+{
+	using std::make_pair;
+
+	namespace core
+	{
+		const vector<Dwarf_Off> type_name_index::no_dies;
+
+		bool type_name_index::tag_is_qualifying_scope(Dwarf_Half tag)
+		{
+			return tag == DW_TAG_namespace
+				|| tag == DW_TAG_structure_type
+				|| tag == DW_TAG_class_type
+				|| tag == DW_TAG_union_type;
+		}
+
+		type_name_index::type_name_index(root_die& r) : r(r)
+		{
+			auto cu_seq = r.children();
+			for (auto i_cu = std::move(cu_seq.first); i_cu != cu_seq.second; ++i_cu)
+			{
+				add_children(i_cu.base(), string(), i_cu.base().spec_here());
+			}
+			/* Definitions first. Within each group, we added in file order. */
+			for (auto i_k = by_key.begin(); i_k != by_key.end(); ++i_k)
+			{
+				vector<Dwarf_Off>& dies = i_k->second.dies;
+				auto first_decl = std::stable_partition(dies.begin(), dies.end(),
+					[&r](Dwarf_Off off) { return !r.pos(off).is_declaration_here(); });
+				i_k->second.ndefinitions = first_decl - dies.begin();
+			}
+		}
+
+		void type_name_index::add_children(const iterator_base& scope,
+			const string& prefix, spec& s)
+		{
+			auto children = scope.children_here();
+			for (auto i = std::move(children.first); i != children.second; ++i)
+			{
+				Dwarf_Half tag = i.tag_here();
+				name_ref name = i.name_ref_here();
+				if (name.empty())
+				{
+					if (tag == DW_TAG_namespace) add_children(i, prefix, s);
+					continue;
+				}
+				string qualified = prefix.empty() ? name.to_string()
+					: prefix + "::" + name.to_string();
+				if (s.tag_is_type(tag))
+				{
+					candidates& c = by_key[make_pair(qualified, tag)];
+					c.dies.push_back(i.offset_here());
+				}
+				if (tag_is_qualifying_scope(tag)) add_children(i, qualified, s);
+			}
+		}
+
+		opt<string> type_name_index::qualified_name_for(const iterator_base& i)
+		{
+			name_ref name = i.name_ref_here();
+			if (name.empty()) return opt<string>();
+			vector<string> components(1, name.to_string());
+			for (iterator_base p = i.parent(); p.depth() > 1; p = p.parent())
+			{
+				Dwarf_Half tag = p.tag_here();
+				if (!tag_is_qualifying_scope(tag)) return opt<string>();
+				name_ref scope_name = p.name_ref_here();
+				if (scope_name.empty())
+				{
+					if (tag == DW_TAG_namespace) continue;
+					return opt<string>();
+				}
+				components.push_back(scope_name.to_string());
+			}
+			string qualified;
+			for (auto i_c = components.rbegin(); i_c != components.rend(); ++i_c)
+			{
+				if (!qualified.empty()) qualified += "::";
+				qualified += *i_c;
+			}
+			return qualified;
+		}
+
+		const vector<Dwarf_Off>&
+		type_name_index::find(const string& qualified, Dwarf_Half tag) const
+		{
+			auto found = by_key.find(make_pair(qualified, tag));
+			return (found == by_key.end()) ? no_dies : found->second.dies;
+		}
+
+		iterator_base
+		type_name_index::find_definition(const string& qualified, Dwarf_Half tag) const
+		{
+			auto found = by_key.find(make_pair(qualified, tag));
+			if (found == by_key.end() || found->second.ndefinitions == 0) return iterator_base::END;
+			return r.pos(found->second.dies.front());
+		}
+
+		iterator_base
+		type_name_index::find_best(const string& qualified, Dwarf_Half tag) const
+		{
+			const vector<Dwarf_Off>& dies = find(qualified, tag);
+			if (dies.empty()) return iterator_base::END;
+			return r.pos(dies.front());
+		}
+
+		iterator_base
+		type_name_index::find_definition_for(const iterator_base& decl) const
+		{
+			opt<string> qualified = qualified_name_for(decl);
+			if (!qualified) return iterator_base::END;
+			return find_definition(*qualified, decl.tag_here());
+		}
+	}
+}
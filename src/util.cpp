@@ -8,6 +8,11 @@
 
 #include <cstdlib>
 #include <sstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
 #include "dwarfpp/util.hpp"
 
 namespace dwarf
@@ -26,5 +31,42 @@ namespace dwarf
 				s >> debug_level;
 			}
 		}
+
+		void parallel_for(unsigned count, unsigned nworkers,
+			const std::function<void(unsigned, unsigned)>& fn)
+		{
+			if (nworkers > count) nworkers = count;
+			if (nworkers <= 1)
+			{
+				for (unsigned n = 0; n < count; ++n) fn(n, 0);
+				return;
+			}
+			std::atomic<unsigned> next(0);
+			std::mutex m;
+			std::exception_ptr first_exception;
+			auto work = [&](unsigned worker) {
+				try
+				{
+					for (unsigned n = next++; n < count; n = next++) fn(n, worker);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> guard(m);
+					if (!first_exception) first_exception = std::current_exception();
+					next = count;
+				}
+			};
+			std::vector<std::thread> threads;
+			for (unsigned w = 1; w < nworkers; ++w) threads.emplace_back(work, w);
+			work(0);
+			for (auto i_t = threads.begin(); i_t != threads.end(); ++i_t) i_t->join();
+			if (first_exception) std::rethrow_exception(first_exception);
+		}
+
+		unsigned hardware_workers()
+		{
+			unsigned n = std::thread::hardware_concurrency();
+			return n ? n : 1;
+		}
 	}
 }
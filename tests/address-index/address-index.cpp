@@ -0,0 +1,76 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <algorithm>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+struct { int a; char b[8]; } static_we_should_find;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	const address_index& idx = r.get_address_index();
+	cout << "Address index has " << idx.size() << " ranged DIEs in "
+		<< idx.segment_count() << " segments" << endl;
+	assert(idx.size() > 0);
+
+	/* Each concrete subprogram's entry point is covered by a chain
+	 * that includes it, and ends at its CU. */
+	unsigned checked = 0;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (i.tag_here() != DW_TAG_subprogram || !i.has_attr_here(DW_AT_low_pc)) continue;
+		auto i_subp = i.as_a<subprogram_die>();
+		Dwarf_Addr lopc = i.attr(DW_AT_low_pc).get_address().addr;
+		auto spanned = i_subp->spans_addr(lopc, r);
+		if (!spanned) continue;
+		assert(*spanned == 0);
+
+		vector<address_index::node_id> chain = idx.chain(lopc);
+		assert(!chain.empty());
+		assert(std::find_if(chain.begin(), chain.end(),
+			[&idx, &i](address_index::node_id n) { return idx.get(n).off == i.offset_here(); })
+				!= chain.end());
+		assert(idx.get(chain.back()).off == i.enclosing_cu_offset_here());
+		address_index::node_id s = idx.enclosing(lopc, DW_TAG_subprogram);
+		assert(s != address_index::NO_NODE);
+		/* The aranges-backed CU lookup agrees. */
+		auto i_cu = r.cu_for_pc(lopc);
+		assert(i_cu && i_cu.offset_here() == i.enclosing_cu_offset_here());
+		++checked;
+	}
+	cout << "Checked " << checked << " subprograms" << endl;
+	assert(checked > 0);
+
+	/* Nothing covers address zero. */
+	assert(idx.innermost(0) == address_index::NO_NODE);
+	assert(!r.cu_for_pc(0));
+	cout << "CU range index has " << r.get_cu_range_index().size() << " ranges, "
+		<< r.get_cu_range_index().cus_patched() << " CUs patched from attributes" << endl;
+
+	/* Data addresses work the same way, down to members. This assumes
+	 * we're not position-independent, so that &x is file-relative. */
+	const static_data_index& data_idx = r.get_static_data_index();
+	cout << "Static data index has " << data_idx.size() << " extents" << endl;
+	Dwarf_Addr addr = reinterpret_cast<Dwarf_Addr>(&static_we_should_find.b[3]);
+	const static_data_index::entry *found = data_idx.find(addr);
+	assert(found);
+	assert(*r.pos(found->var).name_here() == "static_we_should_find");
+	Dwarf_Unsigned residual;
+	vector<iterator_base> members = static_data_index::members_at(r, *found, addr, &residual);
+	assert(members.size() == 1);
+	assert(*members[0].name_here() == "b");
+	assert(residual == 0);
+
+	return 0;
+}
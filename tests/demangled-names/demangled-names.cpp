@@ -0,0 +1,73 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+namespace probe
+{
+	struct widget
+	{
+		int frob(int x) const { return x + 1; }
+		int frob(double x) const { return 2; }
+	};
+}
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+	probe::widget w;
+	int ret = w.frob(1) + w.frob(1.0);
+
+	const demangled_name_index& idx = r.get_demangled_name_index();
+	cout << "Demangled name index has " << idx.size() << " DIEs under "
+		<< idx.distinct_mangled_names() << " mangled names" << endl;
+	assert(idx.size() > 0);
+
+	/* Whitespace doesn't matter, and we find the declaration and the
+	 * out-of-line definition. */
+	vector<Dwarf_Off> found = idx.find_signature("probe::widget::frob(int) const");
+	assert(!found.empty());
+	assert(found == idx.find_signature("probe::widget::frob( int )const"));
+	for (auto i_f = found.begin(); i_f != found.end(); ++i_f)
+	{
+		assert(r.pos(*i_f).tag_here() == DW_TAG_subprogram);
+	}
+	/* Both overloads are under the qualified name. */
+	vector<Dwarf_Off> overloads = idx.find_qualified("probe::widget::frob");
+	assert(overloads.size() > found.size());
+
+	/* C functions are under their plain name. */
+	assert(!idx.find_signature("main").empty());
+	assert(idx.demangle("_ZNK5probe6widget4frobEi")
+		&& *idx.demangle("_ZNK5probe6widget4frobEi") == "probe::widget::frob(int) const");
+	assert(!idx.demangle("main"));
+
+	/* A local static is named after its function, not filed under it. */
+	assert(idx.demangle("_ZZ3foovE1x") && *idx.demangle("_ZZ3foovE1x") == "foo()::x");
+	assert(demangled_name_index::strip_signature(
+		demangled_name_index::normalize("foo()::x")) == "foo()::x");
+	assert(demangled_name_index::strip_signature(
+		demangled_name_index::normalize("probe::widget::frob(int) const &&")) == "probe::widget::frob");
+
+	/* Demangling on one thread or several files the same DIEs. */
+	std::ifstream in2(argv[0]);
+	assert(in2);
+	core::root_die r2(fileno(in2));
+	r2.set_index_workers(1);
+	const demangled_name_index& idx2 = r2.get_demangled_name_index();
+	assert(idx2.size() == idx.size());
+	assert(idx2.distinct_mangled_names() == idx.distinct_mangled_names());
+	assert(idx2.find_signature("probe::widget::frob(int) const") == found);
+	assert(idx2.find_qualified("probe::widget::frob") == overloads);
+
+	return ret == 4 ? 0 : 1;
+}
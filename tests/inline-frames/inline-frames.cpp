@@ -0,0 +1,51 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+/* Even at -O0, this gets inlined, giving us an inlined_subroutine. */
+static inline __attribute__((always_inline)) int inlined_probe(int x)
+{ return x * 2; }
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+	int ret = inlined_probe(argc) - 2 * argc;
+
+	const inline_frame_index& frames = r.get_inline_frame_index();
+	unsigned checked = 0;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (i.tag_here() != DW_TAG_inlined_subroutine || !i.has_attr_here(DW_AT_low_pc)) continue;
+		Dwarf_Addr lopc = i.attr(DW_AT_low_pc).get_address().addr;
+		vector<inline_frame_index::frame> stack = frames.stack(lopc);
+		if (stack.empty()) continue;
+		/* The inlined call itself is innermost, with its origin resolved
+		 * to something that has a name, and the call site known. */
+		assert(stack.front().die == i.offset_here());
+		assert(stack.front().call_line != 0);
+		auto i_origin = r.pos(stack.front().origin);
+		assert(i_origin.tag_here() == DW_TAG_subprogram);
+		if (i_origin.name_here() && *i_origin.name_here() == "inlined_probe")
+		{
+			assert(r.pos(stack.back().die).name_here()
+				&& *r.pos(stack.back().die).name_here() == "main");
+			++checked;
+		}
+		assert(stack.back().tag == DW_TAG_subprogram);
+		assert(frames.inline_depth(lopc) == stack.size() - 1);
+	}
+	cout << "Checked " << checked << " calls to inlined_probe" << endl;
+	assert(checked > 0);
+
+	return ret;
+}
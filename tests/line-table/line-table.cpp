@@ -0,0 +1,77 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <algorithm>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	/* Find main, and its CU's line table. */
+	iterator_df<subprogram_die> i_main;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (i.tag_here() == DW_TAG_subprogram && i.name_here() && *i.name_here() == "main"
+			&& i.has_attr_here(DW_AT_low_pc)) { i_main = i; break; }
+	}
+	assert(i_main);
+	const line_table& lines = i_main.enclosing_cu()->get_line_table();
+	cout << "Line table has " << lines.size() << " rows in " << lines.sequence_count()
+		<< " sequences, using " << lines.bytes_used() << " bytes" << endl;
+	assert(lines.size() > 0);
+
+	/* main's entry is on its declared line, in its declared file. */
+	Dwarf_Addr lopc = i_main.attr(DW_AT_low_pc).get_address().addr;
+	opt<line_table::row> found = lines.find(lopc);
+	assert(found);
+	assert(found->line == i_main.attr(DW_AT_decl_line).get_unsigned());
+	assert(found->file == i_main.attr(DW_AT_decl_file).get_unsigned());
+
+	/* ... and the reverse index agrees. */
+	vector<Dwarf_Addr> addrs = lines.addresses_for(found->file, found->line);
+	assert(std::find(addrs.begin(), addrs.end(), found->addr) != addrs.end());
+
+	/* Decoding everything gives back rows in order within sequences. */
+	vector<line_table::row> rows = lines.all_rows();
+	assert(rows.size() == lines.size());
+	for (unsigned n = 1; n < rows.size(); ++n)
+	{
+		if (!rows[n - 1].end_sequence) assert(rows[n].addr >= rows[n - 1].addr);
+	}
+	assert(!lines.find(0));
+
+	/* Decoding every CU up front, on one thread or several, gives the
+	 * same table as decoding on first use. */
+	for (unsigned nworkers : { 1u, 4u })
+	{
+		std::ifstream in2(argv[0]);
+		assert(in2);
+		core::root_die r2(fileno(in2));
+		r2.set_index_workers(nworkers);
+		r2.load_line_tables();
+		auto cu2 = r2.cu_pos(i_main.enclosing_cu_offset_here());
+		vector<line_table::row> rows2 = cu2->get_line_table().all_rows();
+		assert(rows2.size() == rows.size());
+		for (unsigned n = 0; n < rows.size(); ++n)
+		{
+			assert(rows2[n].addr == rows[n].addr);
+			assert(rows2[n].file == rows[n].file);
+			assert(rows2[n].line == rows[n].line);
+			assert(rows2[n].column == rows[n].column);
+			assert(rows2[n].is_stmt == rows[n].is_stmt);
+			assert(rows2[n].end_sequence == rows[n].end_sequence);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <memory>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	std::unique_ptr<core::root_die> p_r(new core::root_die(fileno(in)));
+
+	/* Copy every location out, keeping both the (pooled) attribute value
+	 * and an unpooled copy of its loclist to check it against later. */
+	vector<encap::attribute_value> kept;
+	vector<encap::loclist> expected;
+	for (auto i = p_r->begin(); i != p_r->end(); ++i)
+	{
+		if (!i.is_real_die_position() || !i.has_attr_here(DW_AT_location)) continue;
+		encap::attribute_map attrs = i.copy_attrs();
+		auto found = attrs.find(DW_AT_location);
+		assert(found != attrs.end());
+		if (!found->second.is_loclist()) continue;
+		kept.push_back(found->second);
+		expected.push_back(found->second.get_loclist());
+	}
+	cout << "Kept " << kept.size() << " locations from a pool of "
+		<< p_r->get_loclist_pool().size() << endl;
+	assert(kept.size() > 0);
+	assert(p_r->get_loclist_pool().size() > 0);
+
+	/* The copies hold their own references, so they outlive the root. */
+	p_r.reset();
+	for (unsigned n = 0; n < kept.size(); ++n)
+	{
+		assert(kept[n].get_loclist() == expected[n]);
+		encap::attribute_value copy = kept[n];
+		assert(copy == kept[n]);
+	}
+	kept.clear();
+
+	return 0;
+}
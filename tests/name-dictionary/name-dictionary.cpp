@@ -0,0 +1,49 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <algorithm>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+int dictionary_probe_one;
+int dictionary_probe_two;
+static void dictionary_probe_function(void) {}
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+	dictionary_probe_function();
+
+	const name_dictionary& dict = r.get_name_dictionary();
+	cout << "Name dictionary has " << dict.distinct_names() << " names for "
+		<< dict.size() << " DIEs" << endl;
+	assert(dict.distinct_names() > 0 && dict.size() >= dict.distinct_names());
+	for (unsigned n = 1; n < dict.distinct_names(); ++n)
+	{
+		assert(dict.name_at(n - 1) < dict.name_at(n));
+	}
+
+	vector<Dwarf_Off> by_prefix = dict.with_prefix("dictionary_probe_");
+	vector<Dwarf_Off> by_glob = dict.matching_glob("dictionary_probe_*");
+	vector<Dwarf_Off> by_regex = dict.matching_regex(boost::regex("dictionary_probe_.*"));
+	assert(by_prefix.size() >= 3);
+	assert(by_prefix == by_glob);
+	assert(by_prefix == by_regex);
+
+	/* Filtering by tag. */
+	assert(dict.with_prefix("dictionary_probe_", DW_TAG_variable).size() >= 2);
+	vector<Dwarf_Off> fns = dict.matching_glob("dictionary_probe_f*", DW_TAG_subprogram);
+	assert(fns.size() == 1);
+	assert(dict.exact("dictionary_probe_function", DW_TAG_subprogram) == fns);
+	assert(dict.exact("dictionary_probe_").empty());
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using namespace dwarf;
+
+/* Exactly the same ops, field by field, not just what loc_expr::operator==
+ * happens to compare. */
+static void assert_same(const encap::loclist& l1, const encap::loclist& l2)
+{
+	assert(l1.size() == l2.size());
+	for (unsigned n = 0; n < l1.size(); ++n)
+	{
+		assert(l1[n].lopc == l2[n].lopc);
+		assert(l1[n].hipc == l2[n].hipc);
+		assert(&l1[n].spec == &l2[n].spec);
+		assert(l1[n].size() == l2[n].size());
+		for (unsigned m = 0; m < l1[n].size(); ++m)
+		{
+			assert(l1[n][m].lr_atom == l2[n][m].lr_atom);
+			assert(l1[n][m].lr_number == l2[n][m].lr_number);
+			assert(l1[n][m].lr_number2 == l2[n][m].lr_number2);
+			assert(l1[n][m].lr_offset == l2[n][m].lr_offset);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	/* Every location in the file should survive packing and unpacking,
+	 * both by hand and through the root's pool. We check both against
+	 * what libdwarf gives us directly. */
+	unsigned nlocs = 0;
+	size_t packed_bytes = 0;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (!i.is_real_die_position() || !i.has_attr_here(DW_AT_location)) continue;
+		Die *p_d = dynamic_cast<Die *>(&i.get_handle());
+		assert(p_d && p_d->handle);
+		core::Attribute a(*p_d, DW_AT_location);
+		encap::loclist expected;
+		switch (a.form_here())
+		{
+			case DW_FORM_exprloc: {
+				auto h = Locdesc::try_construct(a);
+				assert(h);
+				expected = encap::loclist(Locdesc(std::move(h)));
+			} break;
+			case DW_FORM_block1: case DW_FORM_block2: case DW_FORM_block4: case DW_FORM_block:
+			case DW_FORM_sec_offset: case DW_FORM_data4: case DW_FORM_data8: {
+				auto h = LocdescList::try_construct(a);
+				assert(h);
+				expected = encap::loclist(LocdescList(std::move(h)));
+			} break;
+			default: continue;
+		}
+
+		encap::attribute_value v = i.attr(DW_AT_location);
+		assert(v.is_loclist());
+		assert_same(v.get_loclist(), expected);
+
+		encap::packed_loclist p(expected);
+		assert(p.size() == expected.size());
+		assert_same(p.unpack(), expected);
+		assert(encap::packed_loclist(p.unpack()) == p);
+		/* Lookup by vaddr finds the entry that starts there. */
+		for (auto i_expr = expected.begin(); i_expr != expected.end(); ++i_expr)
+		{
+			if (i_expr->lopc >= i_expr->hipc) continue;
+			auto found = p.entry_for_vaddr(i_expr->lopc);
+			assert(found != p.end());
+			assert(found->covers(i_expr->lopc));
+		}
+		packed_bytes += p.bytes_used();
+		++nlocs;
+	}
+	cout << "Packed " << nlocs << " locations into " << packed_bytes << " bytes; the pool holds "
+		<< r.get_loclist_pool().size() << " distinct ones in "
+		<< r.get_loclist_pool().bytes_used() << " bytes" << endl;
+	assert(nlocs > 0);
+
+	return 0;
+}
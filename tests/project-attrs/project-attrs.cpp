@@ -0,0 +1,57 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	vector<Dwarf_Half> attrs = { DW_AT_name, DW_AT_type, DW_AT_byte_size, DW_AT_decl_file };
+	attr_columns cols = project_attrs(r, DW_TAG_member, attrs);
+	cout << "Projected " << cols.size() << " members" << endl;
+	assert(cols.size() > 0);
+
+	/* Check every row against the slow path. */
+	const attr_columns::column *names = cols.col(DW_AT_name);
+	const attr_columns::column *types = cols.col(DW_AT_type);
+	assert(names && types);
+	for (unsigned row = 0; row < cols.size(); ++row)
+	{
+		auto i = r.pos(cols.offsets[row]);
+		assert(i.tag_here() == DW_TAG_member);
+		auto m = i.copy_attrs();
+		auto found_name = m.find(DW_AT_name);
+		assert((found_name != m.end()) == names->has(row));
+		if (found_name != m.end())
+		{
+			assert(cols.string_at(*names, row) == found_name->second.get_string());
+		}
+		auto found_type = m.find(DW_AT_type);
+		assert((found_type != m.end()) == types->has(row));
+		if (found_type != m.end())
+		{
+			assert(types->kind(row) == attr_columns::REFERENCE);
+			assert(types->get_unsigned(row) == found_type->second.get_refoff());
+		}
+	}
+
+	/* Interning means equal names get equal atoms. */
+	for (unsigned row = 1; row < cols.size(); ++row)
+	{
+		if (!names->has(row) || !names->has(row - 1)) continue;
+		assert((names->values[row] == names->values[row - 1])
+			== (cols.string_at(*names, row) == cols.string_at(*names, row - 1)));
+	}
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <set>
+#include <algorithm>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::set;
+using std::multiset;
+using std::vector;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	/* First, the slow way. */
+	vector<iterator_base> walked = r.find_all_visible_grandchildren_named("unsigned int");
+	assert(walked.size() > 0);
+	set<Dwarf_Off> walked_offs;
+	for (auto i = walked.begin(); i != walked.end(); ++i) walked_offs.insert(i->offset_here());
+
+	/* The trie should agree, and building it shouldn't change what
+	 * resolution finds. */
+	const qualified_name_index& idx = r.get_qualified_name_index();
+	cout << "Qualified name index has " << idx.size() << " nodes" << endl;
+	const vector<Dwarf_Off>& tried = idx.find("unsigned int");
+	assert(set<Dwarf_Off>(tried.begin(), tried.end()) == walked_offs);
+	vector<iterator_base> resolved = r.find_all_visible_grandchildren_named("unsigned int");
+	assert(resolved.size() == walked.size());
+
+	/* Every DIE is named as its node says, and sits under a DIE
+	 * of its node's parent. */
+	unsigned nested = 0;
+	for (qualified_name_index::node_id n = 1; n < idx.size(); ++n)
+	{
+		qualified_name_index::node_id parent = idx.parent_of(n);
+		for (auto i_off = idx.dies_at(n).begin(); i_off != idx.dies_at(n).end(); ++i_off)
+		{
+			auto i = r.pos(*i_off);
+			assert(i.name_ref_here() == idx.component_of(n));
+			if (parent == qualified_name_index::ROOT_NODE) assert(i.depth() == 2);
+			else
+			{
+				const vector<Dwarf_Off>& parent_dies = idx.dies_at(parent);
+				assert(std::find(parent_dies.begin(), parent_dies.end(),
+					i.parent().offset_here()) != parent_dies.end());
+				++nested;
+			}
+		}
+		vector<string> path = idx.path_of(n);
+		assert(idx.find_node(path.begin(), path.end()) == n);
+	}
+	cout << "Checked " << nested << " nested qualified names" << endl;
+	assert(nested > 0);
+
+	/* Resolution answered from the trie finds just what it finds without,
+	 * both from the root and from each first hit's CU. */
+	std::ifstream in2(argv[0]);
+	assert(in2);
+	core::root_die r2(fileno(in2)); // never builds a trie
+	unsigned stride = idx.size() / 2000 + 1;
+	for (qualified_name_index::node_id n = 1; n < idx.size(); n += stride)
+	{
+		vector<string> path = idx.path_of(n);
+		vector<iterator_base> with_trie, without_trie;
+		r.resolve_all_visible_from_root(path.begin(), path.end(), with_trie);
+		r2.resolve_all_visible_from_root(path.begin(), path.end(), without_trie);
+		multiset<Dwarf_Off> offs, offs2;
+		for (auto i = with_trie.begin(); i != with_trie.end(); ++i) offs.insert(i->offset_here());
+		for (auto i = without_trie.begin(); i != without_trie.end(); ++i) offs2.insert(i->offset_here());
+		assert(offs == offs2);
+		if (with_trie.empty()) continue;
+		Dwarf_Off cu_off = with_trie[0].enclosing_cu_offset_here();
+		iterator_base found = r.resolve(r.pos(cu_off, 1), path.begin(), path.end());
+		iterator_base found2 = r2.resolve(r2.pos(cu_off, 1), path.begin(), path.end());
+		assert(!found == !found2);
+		if (found) assert(found.offset_here() == found2.offset_here());
+	}
+
+	return 0;
+}
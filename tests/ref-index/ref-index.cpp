@@ -0,0 +1,67 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::map;
+using std::pair;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	/* A depth-first walk knows everybody's depth and parent. */
+	map<Dwarf_Off, pair<unsigned short, Dwarf_Off> > where;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (!i.is_real_die_position()) continue;
+		where[i.offset_here()] = make_pair(i.depth(), i.parent().offset_here());
+	}
+
+	/* Following a reference should land us somewhere that already knows
+	 * its depth, and agrees with the walk. */
+	core::root_die r2(fileno(in));
+	unsigned nrefs = 0;
+	for (auto i = r2.begin(); i != r2.end(); ++i)
+	{
+		if (!i.is_real_die_position() || !i.has_attr_here(DW_AT_type)) continue;
+		auto t = i.attr(DW_AT_type).get_refiter();
+		assert(t);
+		assert(t.maybe_depth());
+		auto found = where.find(t.offset_here());
+		assert(found != where.end());
+		assert(*t.maybe_depth() == found->second.first);
+		assert(t.parent().offset_here() == found->second.second);
+		++nrefs;
+	}
+	cout << "Followed " << nrefs << " type references" << endl;
+	assert(nrefs > 0);
+
+	/* Bulk reference indexing agrees with following them one by one. */
+	std::unordered_map<Dwarf_Off, Dwarf_Off> parent_of;
+	map<pair<Dwarf_Off, Dwarf_Half>, Dwarf_Off> refers_to;
+	r2.get_referential_structure(parent_of, refers_to);
+	for (auto i = r2.begin(); i != r2.end(); ++i)
+	{
+		if (!i.is_real_die_position() || !i.has_attr_here(DW_AT_type)) continue;
+		auto found = refers_to.find(make_pair(i.offset_here(), (Dwarf_Half) DW_AT_type));
+		assert(found != refers_to.end());
+		assert(found->second == i.attr(DW_AT_type).get_refoff());
+	}
+	/* ... and knows every DIE's parent, as the walk does. */
+	for (auto i_w = where.begin(); i_w != where.end(); ++i_w)
+	{
+		auto found = parent_of.find(i_w->first);
+		assert(found != parent_of.end());
+		assert(found->second == i_w->second.second);
+	}
+
+	return 0;
+}
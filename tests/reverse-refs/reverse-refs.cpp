@@ -0,0 +1,56 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <algorithm>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	reverse_reference_index idx(r);
+	cout << "Reverse index has " << idx.size() << " references to "
+		<< idx.all_targets().size() << " DIEs" << endl;
+	assert(idx.size() > 0);
+
+	/* Every DW_AT_type reference shows up backwards. */
+	unsigned checked = 0;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (!i.has_attr_here(DW_AT_type)) continue;
+		Dwarf_Off target = i.attr(DW_AT_type).get_ref().off;
+		vector<Dwarf_Off> referrers = idx.referrers(target, DW_AT_type);
+		assert(std::find(referrers.begin(), referrers.end(), i.offset_here())
+			!= referrers.end());
+		assert(idx.is_referenced(target));
+		++checked;
+	}
+	cout << "Checked " << checked << " type references" << endl;
+	assert(checked > 0);
+
+	/* Walking the CUs on one thread or several finds the same references. */
+	for (unsigned nworkers : { 1u, 4u })
+	{
+		std::ifstream in2(argv[0]);
+		assert(in2);
+		core::root_die r2(fileno(in2));
+		r2.set_index_workers(nworkers);
+		r2.index_all_references();
+		assert(r2.get_refers_to() == r.get_refers_to());
+	}
+
+	/* Nothing refers to a CU. */
+	auto cus = r.children();
+	assert(!idx.is_referenced(cus.first.offset_here()));
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using namespace dwarf;
+
+/* Inlined even without optimisation, so that we have an inlined call. */
+static inline __attribute__((always_inline)) int twice(int x) { return 2 * x; }
+
+/* Where a DIE's code is, by low_pc and high_pc or by DW_AT_ranges. */
+static vector<std::pair<Dwarf_Addr, Dwarf_Addr> > ranges_of(core::root_die& r,
+	const core::iterator_base& i)
+{
+	vector<std::pair<Dwarf_Addr, Dwarf_Addr> > out;
+	if (i.has_attr_here(DW_AT_ranges))
+	{
+		auto i_cu = r.cu_pos(i.enclosing_cu_offset_here());
+		auto rangelist = i_cu->normalize_rangelist(i.attr(DW_AT_ranges).get_rangelist());
+		for (auto i_r = rangelist.begin(); i_r != rangelist.end(); ++i_r)
+		{
+			if (i_r->dwr_type == DW_RANGES_ENTRY && i_r->dwr_addr2 > i_r->dwr_addr1)
+			{ out.push_back(std::make_pair(i_r->dwr_addr1, i_r->dwr_addr2)); }
+		}
+	}
+	else if (i.has_attr_here(DW_AT_low_pc) && i.has_attr_here(DW_AT_high_pc))
+	{
+		Dwarf_Addr lopc = i.attr(DW_AT_low_pc).get_address().addr;
+		encap::attribute_value high = i.attr(DW_AT_high_pc);
+		Dwarf_Addr hipc = (high.get_form() == encap::attribute_value::ADDR)
+			? high.get_address().addr : lopc + high.get_unsigned();
+		if (hipc > lopc) out.push_back(std::make_pair(lopc, hipc));
+	}
+	return out;
+}
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	/* Every concrete subprogram's entry, twice over, out of order,
+	 * with some addresses nothing covers. */
+	vector<Dwarf_Addr> addrs;
+	vector<Dwarf_Off> expected;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		if (i.tag_here() != DW_TAG_subprogram || !i.has_attr_here(DW_AT_low_pc)) continue;
+		Dwarf_Addr lopc = i.attr(DW_AT_low_pc).get_address().addr;
+		if (r.get_inline_frame_index().stack(lopc).empty()) continue;
+		addrs.push_back(lopc);
+		expected.push_back(i.offset_here());
+	}
+	assert(!addrs.empty());
+	unsigned nfuncs = addrs.size();
+	for (unsigned n = nfuncs; n-- > 0; )
+	{
+		addrs.push_back(addrs[n]);
+		expected.push_back(expected[n]);
+	}
+	addrs.push_back(0);
+	expected.push_back(0);
+
+	batch_symbolization batch(r, addrs);
+	cout << "Symbolized " << addrs.size() << " addresses, " << batch.distinct_addresses()
+		<< " distinct" << endl;
+	assert(batch.results().size() == addrs.size());
+	assert(batch.distinct_addresses() == nfuncs + 1);
+	for (unsigned n = 0; n < addrs.size(); ++n)
+	{
+		const batch_symbolization::result& res = batch.results()[n];
+		assert(res.addr == addrs[n]);
+		assert(res.function == expected[n]);
+		if (!expected[n]) continue;
+		/* The answers are those we get one address at a time. */
+		assert(res.cu == r.pos(expected[n]).enclosing_cu_offset_here());
+		opt<line_table::row> line = r.cu_pos(res.cu)->get_line_table().find(addrs[n]);
+		assert(!!line == !!res.line);
+		if (line) assert(line->line == res.line->line && line->file == res.line->file);
+		auto chain = batch.inline_chain(res);
+		assert(chain.second - chain.first == r.get_inline_frame_index().stack(addrs[n]).size());
+		assert((chain.second - 1)->die == expected[n]);
+	}
+
+	/* Every byte of main and of an inlined call, where answers change
+	 * mid-function, agrees with one-address-at-a-time lookups. */
+	vector<Dwarf_Addr> dense;
+	bool saw_main = false, saw_inlined = false;
+	for (auto i = r.begin(); i != r.end(); ++i)
+	{
+		bool is_main = !saw_main && i.tag_here() == DW_TAG_subprogram
+			&& i.name_here() && *i.name_here() == "main";
+		bool is_inlined = !saw_inlined && i.tag_here() == DW_TAG_inlined_subroutine;
+		if (!is_main && !is_inlined) continue;
+		auto ranges = ranges_of(r, i);
+		if (ranges.empty()) continue;
+		for (auto i_r = ranges.begin(); i_r != ranges.end(); ++i_r)
+		{
+			for (Dwarf_Addr a = i_r->first; a < i_r->second; ++a) dense.push_back(a);
+		}
+		saw_main |= is_main;
+		saw_inlined |= is_inlined;
+	}
+	assert(saw_main && saw_inlined);
+	batch_symbolization dense_batch(r, dense);
+	const address_index& idx = r.get_address_index();
+	for (unsigned n = 0; n < dense.size(); ++n)
+	{
+		const batch_symbolization::result& res = dense_batch.results()[n];
+		assert(res.addr == dense[n]);
+		/* The stack, frame by frame... */
+		vector<inline_frame_index::frame> stack = r.get_inline_frame_index().stack(dense[n]);
+		auto chain = dense_batch.inline_chain(res);
+		assert((unsigned) (chain.second - chain.first) == stack.size());
+		for (unsigned m = 0; m < stack.size(); ++m)
+		{
+			assert(chain.first[m].die == stack[m].die);
+			assert(chain.first[m].call_line == stack[m].call_line);
+		}
+		assert(res.function == (stack.empty() ? 0 : stack.back().die));
+		/* ... whose innermost frame encloses the innermost ranged DIE... */
+		address_index::node_id node = idx.innermost(dense[n]);
+		while (node != address_index::NO_NODE && idx.get(node).tag != DW_TAG_subprogram
+			&& idx.get(node).tag != DW_TAG_inlined_subroutine) node = idx.get(node).parent;
+		assert(node != address_index::NO_NODE && !stack.empty());
+		assert(idx.get(node).off == chain.first->die);
+		/* ... and the line in effect. */
+		assert(res.cu == r.pos(res.function).enclosing_cu_offset_here());
+		opt<line_table::row> line = r.cu_pos(res.cu)->get_line_table().find(dense[n]);
+		assert(!!line == !!res.line);
+		if (line) assert(line->addr == res.line->addr && line->line == res.line->line
+			&& line->file == res.line->file && line->column == res.line->column);
+	}
+	cout << "Checked " << dense.size() << " dense addresses" << endl;
+
+	return twice(0);
+}
@@ -0,0 +1,74 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <elf.h>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using namespace dwarf;
+
+int global_we_should_join = 42;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	const symbol_index& idx = r.get_symbol_index();
+	cout << "Symbol index has " << idx.size() << " symbols" << endl;
+	assert(idx.size() > 0);
+
+	/* main is a symbol, at an address it covers, and joins with its DIE. */
+	opt<symbol_index::sym_id> s_main = idx.find("main");
+	assert(s_main);
+	const symbol_index::symbol& sym = idx.get(*s_main);
+	opt<symbol_index::sym_id> s_covering = idx.covering(sym.value);
+	assert(s_covering && idx.get(*s_covering).value == sym.value);
+	iterator_base i_main = idx.die_for(*s_main);
+	assert(i_main);
+	assert(i_main.tag_here() == DW_TAG_subprogram);
+	assert(i_main.name_here() && *i_main.name_here() == "main");
+	assert(idx.symbol_for(i_main) == s_main);
+
+	/* The resolver agrees with the symbol table. */
+	auto resolve = idx.resolver();
+	auto binding = resolve("global_we_should_join", nullptr);
+	opt<symbol_index::sym_id> s_global = idx.find("global_we_should_join");
+	assert(s_global);
+	assert(binding.file_relative_start_addr == idx.get(*s_global).value);
+	assert(binding.size == sizeof global_we_should_join);
+	iterator_base i_global = idx.die_for(*s_global);
+	assert(i_global && i_global.tag_here() == DW_TAG_variable);
+
+	bool threw = false;
+	try { resolve("no_such_symbol_we_hope", nullptr); }
+	catch (lib::No_entry) { threw = true; }
+	assert(threw);
+
+	/* A function symbol joined by address names the subprogram's start,
+	 * not just some address within it. */
+	for (symbol_index::sym_id s = 0; s < idx.size(); ++s)
+	{
+		if (idx.get(s).type != STT_FUNC) continue;
+		iterator_base i = idx.die_for(s);
+		if (!i || idx.symbol_for(i) == opt<symbol_index::sym_id>(s)) continue;
+		assert(i.has_attr_here(DW_AT_low_pc));
+		assert(i.attr(DW_AT_low_pc).get_address().addr == idx.get(s).value);
+	}
+
+	/* Adding a DIE keeps the symbols, dropping only the join, and the
+	 * resolver still works. */
+	Dwarf_Addr global_addr = binding.file_relative_start_addr;
+	unsigned nsyms = idx.size();
+	r.make_new(r.get_or_create_synthetic_cu(), DW_TAG_base_type);
+	assert(&r.get_symbol_index() == &idx);
+	assert(idx.size() == nsyms);
+	assert(idx.die_for(*s_main).offset_here() == i_main.offset_here());
+	assert(resolve("global_we_should_join", nullptr).file_relative_start_addr == global_addr);
+
+	return 0;
+}
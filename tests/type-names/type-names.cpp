@@ -0,0 +1,45 @@
+#undef NDEBUG // assert is part of our logic
+#include <fstream>
+#include <fileno.hpp>
+#include <dwarfpp/lib.hpp>
+
+using std::cout;
+using std::endl;
+using std::string;
+using namespace dwarf;
+
+namespace outer { namespace inner { struct nested_type { int x; } nested_instance; } }
+struct declared_only *p_declared_only;
+
+int main(int argc, char **argv)
+{
+	using namespace dwarf::core;
+	// using our own debug info...
+	std::ifstream in(argv[0]);
+	assert(in);
+	core::root_die r(fileno(in));
+
+	const type_name_index& idx = r.get_type_name_index();
+	cout << "Type name index has " << idx.size() << " keys" << endl;
+	assert(idx.size() > 0);
+
+	/* A type nested in namespaces is found by its qualified name. */
+	iterator_base found = idx.find_definition("outer::inner::nested_type", DW_TAG_structure_type);
+	assert(found);
+	cout << "Found " << found.summary() << endl;
+	assert(!found.has_attr_here(DW_AT_declaration));
+	opt<string> qualified = type_name_index::qualified_name_for(found);
+	assert(qualified && *qualified == "outer::inner::nested_type");
+	/* ... but not by its unqualified one, nor with the wrong tag. */
+	assert(idx.find("nested_type", DW_TAG_structure_type).empty());
+	assert(!idx.find_definition("outer::inner::nested_type", DW_TAG_union_type));
+
+	/* A declared-only struct has candidates, but no definition. */
+	assert(!idx.find("declared_only", DW_TAG_structure_type).empty());
+	assert(!idx.find_definition("declared_only", DW_TAG_structure_type));
+	assert(idx.find_best("declared_only", DW_TAG_structure_type));
+	iterator_base decl = r.pos(idx.find("declared_only", DW_TAG_structure_type).front());
+	assert(!idx.find_definition_for(decl));
+
+	return 0;
+}
@@ -1,5 +1,6 @@
 #undef NDEBUG // assert is part of our logic
 #include <fstream>
+#include <set>
 #include <fileno.hpp>
 #include <dwarfpp/lib.hpp>
 #include <srk31/algorithm.hpp>
@@ -48,5 +49,27 @@ int main(int argc, char **argv)
 	 = r.find_all_visible_grandchildren_named("unsigned int");
 	assert(results.size() == results2.size());
 
+	/* The index comes out the same whether it's built on the calling
+	 * thread or spread over several workers. */
+	std::set<Dwarf_Off> offs;
+	for (auto i = results.begin(); i != results.end(); ++i) offs.insert(i->offset_here());
+	for (unsigned nworkers : { 1u, 4u })
+	{
+		std::ifstream in_again(argv[0]);
+		assert(in_again);
+		core::root_die r_again(fileno(in_again));
+		r_again.set_index_workers(nworkers);
+		std::vector<iterator_base> results_again
+		 = r_again.find_all_visible_grandchildren_named("unsigned int");
+		std::set<Dwarf_Off> offs_again;
+		for (auto i = results_again.begin(); i != results_again.end(); ++i)
+		{
+			offs_again.insert(i->offset_here());
+		}
+		assert(offs_again == offs);
+		auto main_again = r_again.find_visible_grandchild_named("main");
+		assert(main_again && main_again.name_here() && *main_again.name_here() == "main");
+	}
+
 	return 0;
 }